@@ -0,0 +1,72 @@
+/**************************************************************************************\
+** File: ParticleBench.cpp
+** Project: Space
+** Author: David Leksen
+** Date:
+**
+** Microbenchmark for ParticleSystem::Update and ParticleSystem::SmoothStates
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "ParticleSystem.h"
+#include <iomanip>
+#include <random>
+
+namespace
+{
+	const unsigned NUM_FRAMES{ 2000 };
+	const float FRAME_TIME{ 1.0f / 120.0f };
+
+	// Keeps the system full so every frame works on MAX_PARTICLES
+	void Refill(Space::ParticleSystem& particleSystem, std::mt19937& generator)
+	{
+		std::uniform_real_distribution<float> position{ -100.0f, 100.0f };
+		std::uniform_real_distribution<float> velocity{ -10.0f, 10.0f };
+		std::uniform_real_distribution<float> lifetime{ 0.5f, 5.0f };
+		Space::ParticleDef def;
+		def.fadeIn = 0.1f;
+		def.fadeOut = 0.2f;
+		while(particleSystem.GetParticleCount() < Space::MAX_PARTICLES)
+		{
+			def.position.Set(position(generator), position(generator));
+			def.velocity.Set(velocity(generator), velocity(generator));
+			def.lifetime = lifetime(generator);
+			particleSystem.AddParticle(def);
+		}
+	}
+
+	// Returns particles updated per millisecond
+	double Run(bool SIMDEnabled)
+	{
+		auto particleSystemPtr{ std::make_unique<Space::ParticleSystem>() };
+		particleSystemPtr->Init();
+		particleSystemPtr->SetSIMDEnabled(SIMDEnabled);
+		std::mt19937 generator{ 1 };
+
+		std::chrono::steady_clock::duration totalTime{};
+		unsigned long long numParticlesUpdated{ 0 };
+		for(unsigned frame = 0; frame < NUM_FRAMES; ++frame)
+		{
+			Refill(*particleSystemPtr, generator);
+			numParticlesUpdated += particleSystemPtr->GetParticleCount();
+
+			auto startTime{ std::chrono::steady_clock::now() };
+			particleSystemPtr->Update(FRAME_TIME);
+			particleSystemPtr->SmoothStates(0.5f);
+			totalTime += std::chrono::steady_clock::now() - startTime;
+		}
+		return numParticlesUpdated / std::chrono::duration<double, std::milli>{ totalTime }.count();
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	double scalarRate{ Run(false) };
+	double SIMDRate{ Run(true) };
+	std::cout << std::fixed << std::setprecision(0)
+		<< Space::MAX_PARTICLES << " particles, " << NUM_FRAMES << " frames" << std::endl
+		<< "scalar:          " << scalarRate << " particles/ms" << std::endl
+		<< "SIMD (width " << Space::ParticleSystem::GetSIMDWidth() << "): " << SIMDRate << " particles/ms"
+		<< std::setprecision(2) << " (" << SIMDRate / scalarRate << "x)" << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,480 @@
+/**************************************************************************************\
+** File: SpaceBench.cpp
+** Project: Space
+** Author: David Leksen
+** Date:
+**
+** Headless benchmark for World::Update. Run from WorkingDir so Data/ is found.
+** Usage: space_bench [--fail-on-alloc] [--seed N] [numSteps] [scenarioName]
+** Prints results as JSON. With --fail-on-alloc, exits with failure if any measured
+** step allocated; allocations are only counted in debug builds. CTest runs it
+** that way as the step_allocations test. Every scenario starts from the same
+** seed, so runs with the same seed simulate the same thing and can be compared.
+** edge_wrapping_swarm_teleport uses the experimental teleport wrap mode, which
+** has no collisions across the world edge ("collisionsAcrossEdge": false), so
+** its times are not equivalent to edge_wrapping_swarm's.
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "World.h"
+#include "WorldDef.h"
+#include "GameSettings.h"
+#include "AllocationCounter.h"
+#include <iomanip>
+
+namespace
+{
+	using namespace Space;
+	const unsigned DEFAULT_NUM_STEPS{ 2000 };
+	const unsigned DEFAULT_SEED{ 12345 };
+	const unsigned WARM_UP_STEPS{ 120 };
+	const b2Vec2 WORLD_DIMENSIONS{ 500.0f, 500.0f };
+
+	//+------------------------\----------------------------------
+	//|		   Entities		   |
+	//\------------------------/----------------------------------
+	// EntityFactory's models load textures, which needs a window, so the scenarios
+	// build entities from the same settings and shapes. Sizes are square because
+	// the width-to-height ratios come from the textures.
+	struct AsteroidType
+	{
+		std::string modelName;
+		float height;
+		float hp;
+		unsigned numParticles;
+		d2d::Range<int> particleSizeIndexRange;
+		float particleLifetime;
+		float particleFadeOut;
+		d2d::Range<float> speedRange;
+		d2d::Range<float> angularVelocityRange;
+	};
+	const AsteroidType XLARGE_ASTEROID{ "asteroidxlarge1"s, XLARGE_ASTEROID_HEIGHT, XLARGE_ASTEROID_HP,
+		XLARGE_ASTEROID_NUM_PARTICLES, XLARGE_ASTEROID_PARTICLE_SIZE_INDEX_RANGE,
+		XLARGE_ASTEROID_PARTICLE_LIFETIME, XLARGE_ASTEROID_PARTICLE_FADEOUT,
+		ASTEROID_STARTING_SPEED_RANGE_XL, ASTEROID_STARTING_ANG_VEL_RANGE_XL };
+	const AsteroidType LARGE_ASTEROID{ "asteroidlarge1"s, LARGE_ASTEROID_HEIGHT, LARGE_ASTEROID_HP,
+		LARGE_ASTEROID_NUM_PARTICLES, LARGE_ASTEROID_PARTICLE_SIZE_INDEX_RANGE,
+		LARGE_ASTEROID_PARTICLE_LIFETIME, LARGE_ASTEROID_PARTICLE_FADEOUT,
+		ASTEROID_STARTING_SPEED_RANGE_L, ASTEROID_STARTING_ANG_VEL_RANGE_L };
+	const AsteroidType MEDIUM_ASTEROID{ "asteroidmedium1"s, MEDIUM_ASTEROID_HEIGHT, MEDIUM_ASTEROID_HP,
+		MEDIUM_ASTEROID_NUM_PARTICLES, MEDIUM_ASTEROID_PARTICLE_SIZE_INDEX_RANGE,
+		MEDIUM_ASTEROID_PARTICLE_LIFETIME, MEDIUM_ASTEROID_PARTICLE_FADEOUT,
+		ASTEROID_STARTING_SPEED_RANGE_M, ASTEROID_STARTING_ANG_VEL_RANGE_M };
+	const AsteroidType SMALL_ASTEROID{ "asteroidsmall1"s, SMALL_ASTEROID_HEIGHT, SMALL_ASTEROID_HP,
+		SMALL_ASTEROID_NUM_PARTICLES, SMALL_ASTEROID_PARTICLE_SIZE_INDEX_RANGE,
+		SMALL_ASTEROID_PARTICLE_LIFETIME, SMALL_ASTEROID_PARTICLE_FADEOUT,
+		ASTEROID_STARTING_SPEED_RANGE_S, ASTEROID_STARTING_ANG_VEL_RANGE_S };
+
+	EntityID CreateAsteroid(World& world, const AsteroidType& type, const InstanceDef& def)
+	{
+		EntityID id{ world.NewEntityID({ type.height, type.height }, DEFAULT_DRAW_LAYER, def.activate) };
+		world.AddPhysicsComponent(id, b2_dynamicBody, def);
+		world.AddShapes(id, type.modelName, ASTEROID_MATERIAL, ASTEROID_FILTER);
+		world.AddHealthComponent(id, type.hp);
+		world.AddParticleExplosionOnDeathComponent(id, PARTICLE_EXPLOSION_RELATIVE_SIZE,
+			type.numParticles, ASTEROID_PARTICLE_SPEED_RANGE, DAMAGE_BASED_SPEED_INCREASE_FACTOR,
+			type.particleSizeIndexRange, ASTEROID_PARTICLE_COLOR_RANGE,
+			type.particleLifetime, PARTICLE_EXPLOSION_FADEIN, type.particleFadeOut);
+		return id;
+	}
+	// Places asteroids away from existing entities, each moving in a random direction
+	void CreateRandomAsteroids(World& world, const AsteroidType& type, unsigned count, std::vector<EntityID>* idsOut = nullptr)
+	{
+		float boundingRadius{ b2Vec2{ type.height, type.height }.Length() * 0.5f };
+		float minGap{ type.height * MIN_BOUNDING_RADII_GAP_RELATIVE_TO_HEIGHT };
+		for(unsigned i = 0; i < count; ++i)
+		{
+			InstanceDef def{
+				.angle = d2d::RandomFloat({ 0.0f, d2d::TWO_PI }),
+				.velocity{ d2d::RandomFloat(type.speedRange) * d2d::GetUnitVec2FromAngle(d2d::RandomFloat({ 0.0f, d2d::TWO_PI })) },
+				.angularVelocity = d2d::RandomFloat(type.angularVelocityRange) };
+			if(world.GetRandomPositionAwayFromExistingEntities(boundingRadius, minGap, MAX_ATTEMPTS_PER_ENTITY, def.position))
+			{
+				EntityID id{ CreateAsteroid(world, type, def) };
+				if(idsOut)
+					idsOut->push_back(id);
+			}
+		}
+	}
+	EntityID CreateBlaster(World& world, const InstanceDef& def, const ProjectileDef& bulletDef)
+	{
+		EntityID id{ world.NewEntityID({ BLASTER_HEIGHT, BLASTER_HEIGHT }, DEFAULT_DRAW_LAYER, def.activate) };
+		world.AddPhysicsComponent(id, b2_dynamicBody, def);
+		world.AddShapes(id, "ship001"s, SHIP_MATERIAL, SHIP_FILTER);
+		world.AddRotatorComponent(id, BLASTER_ROTATION_SPEED);
+		world.AddHealthComponent(id, BLASTER_HP);
+
+		// Same five guns as a fully upgraded player ship
+		world.AddProjectileLauncherComponent(id, 5, false);
+		world.AddProjectileLauncher(id, 0, bulletDef, { BLASTER_PROJECTILE_OFFSET_X, 0.0f }, BLASTER_CANON_IMPULSE, BLASTER_CANON_INTERVAL, false, false);
+		world.AddProjectileLauncher(id, 1, bulletDef, { BLASTER_PROJECTILE_OFFSET_X,  BLASTER_PROJECTILE_INNER_SPREAD_Y }, BLASTER_CANON_IMPULSE, BLASTER_CANON_INTERVAL, false, false);
+		world.AddProjectileLauncher(id, 2, bulletDef, { BLASTER_PROJECTILE_OFFSET_X, -BLASTER_PROJECTILE_INNER_SPREAD_Y }, BLASTER_CANON_IMPULSE, BLASTER_CANON_INTERVAL, false, false);
+		world.AddProjectileLauncher(id, 3, bulletDef, { BLASTER_PROJECTILE_OFFSET_X,  BLASTER_PROJECTILE_OUTER_SPREAD_Y }, BLASTER_CANON_IMPULSE, BLASTER_CANON_INTERVAL, false, false);
+		world.AddProjectileLauncher(id, 4, bulletDef, { BLASTER_PROJECTILE_OFFSET_X, -BLASTER_PROJECTILE_OUTER_SPREAD_Y }, BLASTER_CANON_IMPULSE, BLASTER_CANON_INTERVAL, false, false);
+		world.SetFlag(id, FLAG_PLAYER_CONTROLLED, true);
+		return id;
+	}
+
+	//+------------------------\----------------------------------
+	//|		  Scenarios		   |
+	//\------------------------/----------------------------------
+	class Scenario
+	{
+	public:
+		virtual ~Scenario() = default;
+		virtual const char* GetName() const = 0;
+
+		// Changes the settings loaded from Data/world.hjson before the world is created
+		virtual void AdjustSettings(WorldDef& settings) const {}
+		virtual void SetUp(World& world) = 0;
+		virtual void BeforeStep(World& world, PlayerController& playerController) {}
+	};
+
+	// Many asteroids of every size bumping into each other
+	class DenseAsteroidField : public Scenario
+	{
+	public:
+		const char* GetName() const override { return "dense_asteroid_field"; }
+		void SetUp(World& world) override
+		{
+			CreateRandomAsteroids(world, XLARGE_ASTEROID, 40);
+			CreateRandomAsteroids(world, LARGE_ASTEROID, 80);
+			CreateRandomAsteroids(world, MEDIUM_ASTEROID, 150);
+			CreateRandomAsteroids(world, SMALL_ASTEROID, 300);
+		}
+	};
+
+	// A ship holding down fire with five guns while turning through a field.
+	// With sweptRay the bullets are swept rays instead of bodies.
+	class SustainedFire : public Scenario
+	{
+	public:
+		explicit SustainedFire(bool sweptRay = false)
+		{
+			m_bulletDef.sweptRay = sweptRay;
+		}
+		const char* GetName() const override
+		{
+			return m_bulletDef.sweptRay ? "sustained_5_gun_ray_fire" : "sustained_5_gun_fire";
+		}
+		void SetUp(World& world) override
+		{
+			CreateBlaster(world, { .position{ world.GetWorldCenter() } }, m_bulletDef);
+			CreateRandomAsteroids(world, XLARGE_ASTEROID, 10);
+			CreateRandomAsteroids(world, LARGE_ASTEROID, 20);
+			CreateRandomAsteroids(world, MEDIUM_ASTEROID, 40);
+			CreateRandomAsteroids(world, SMALL_ASTEROID, 80);
+		}
+		void BeforeStep(World& world, PlayerController& playerController) override
+		{
+			playerController.primaryFireFactor = 1.0f;
+			playerController.turnFactor = 0.25f;
+		}
+	private:
+		ProjectileDef m_bulletDef{ Model{ "fireball1"s, nullptr },
+			BULLET_MATERIAL,
+			{ BULLET_HEIGHT, BULLET_HEIGHT },
+			BULLET_FIXED_ROTATION,
+			BULLET_CONTINUOUS_COLLISION_DETECTION,
+			BULLET_FILTER,
+			BULLET_DESTRUCTION_DELAY,
+			BULLET_DESTRUCTION_DELAY_TIME,
+			BULLET_DESTRUCTION_DELAY_ON_CONTACT,
+			BULLET_DESTRUCTION_DELAY_ON_CONTACT_TIME,
+			BULLET_DESTRUCTION_CHANCE_ON_CONTACT,
+			BULLET_DESTRUCTION_CHANCE,
+			BULLET_IGNORE_PARENT_COLLISIONS_UNTIL_FIRST_CONTACT,
+			BULLET_ACCELERATION,
+			BULLET_ACCELERATION_TIME,
+			BULLET_SWEPT_RAY };
+	};
+
+	// Asteroids blown up in batches and replaced, keeping the particle system busy
+	class MassExplosions : public Scenario
+	{
+	public:
+		const char* GetName() const override { return "mass_explosions"; }
+		void SetUp(World& world) override
+		{
+			m_asteroidIDs.clear();
+			m_nextAsteroid = 0;
+			m_stepsUntilExplosions = STEPS_BETWEEN_EXPLOSIONS;
+			CreateRandomAsteroids(world, MEDIUM_ASTEROID, 200, &m_asteroidIDs);
+			CreateRandomAsteroids(world, SMALL_ASTEROID, 300, &m_asteroidIDs);
+		}
+		void BeforeStep(World& world, PlayerController& playerController) override
+		{
+			if(--m_stepsUntilExplosions > 0)
+				return;
+			m_stepsUntilExplosions = STEPS_BETWEEN_EXPLOSIONS;
+
+			unsigned numExploded{ 0 };
+			for(; numExploded < EXPLOSIONS_PER_BATCH && m_nextAsteroid < m_asteroidIDs.size(); ++m_nextAsteroid)
+				if(world.EntityExists(m_asteroidIDs[m_nextAsteroid]))
+				{
+					world.Destroy(m_asteroidIDs[m_nextAsteroid]);
+					++numExploded;
+				}
+			CreateRandomAsteroids(world, SMALL_ASTEROID, numExploded, &m_asteroidIDs);
+		}
+	private:
+		static constexpr unsigned STEPS_BETWEEN_EXPLOSIONS{ 60 };
+		static constexpr unsigned EXPLOSIONS_PER_BATCH{ 100 };
+		std::vector<EntityID> m_asteroidIDs;
+		size_t m_nextAsteroid{ 0 };
+		unsigned m_stepsUntilExplosions{ 0 };
+	};
+
+	// Fast asteroids near the edges, so many are wrapping or have clones at once.
+	// The teleport run shows what the clone bodies cost, but it is not the same
+	// work: without clones nothing collides across the world edge.
+	class EdgeWrappingSwarm : public Scenario
+	{
+	public:
+		explicit EdgeWrappingSwarm(WrapMode wrapMode)
+			: m_wrapMode{ wrapMode }
+		{}
+		const char* GetName() const override
+		{
+			return m_wrapMode == WrapMode::CLONES ? "edge_wrapping_swarm" : "edge_wrapping_swarm_teleport";
+		}
+		void AdjustSettings(WorldDef& settings) const override
+		{
+			settings.wrapMode = m_wrapMode;
+		}
+		void SetUp(World& world) override
+		{
+			const d2d::Rect& worldRect{ world.GetWorldRect() };
+			const float BAND_WIDTH{ 20.0f };
+			const d2d::Range<float> SPEED_RANGE{ 10.0f, 20.0f };
+			for(unsigned i = 0; i < NUM_ASTEROIDS; ++i)
+			{
+				// Alternate between the four edges, heading out through the edge
+				InstanceDef def{ .angle = d2d::RandomFloat({ 0.0f, d2d::TWO_PI }) };
+				float speed{ d2d::RandomFloat(SPEED_RANGE) };
+				float along{ d2d::RandomFloat({ -0.5f, 0.5f }) };
+				float into{ d2d::RandomFloat({ 0.0f, BAND_WIDTH }) };
+				switch(i % 4)
+				{
+				case 0:
+					def.position.Set(worldRect.lowerBound.x + into, along * WORLD_DIMENSIONS.y);
+					def.velocity.Set(-speed, along * speed);
+					break;
+				case 1:
+					def.position.Set(worldRect.upperBound.x - into, along * WORLD_DIMENSIONS.y);
+					def.velocity.Set(speed, along * speed);
+					break;
+				case 2:
+					def.position.Set(along * WORLD_DIMENSIONS.x, worldRect.lowerBound.y + into);
+					def.velocity.Set(along * speed, -speed);
+					break;
+				default:
+					def.position.Set(along * WORLD_DIMENSIONS.x, worldRect.upperBound.y - into);
+					def.velocity.Set(along * speed, speed);
+					break;
+				}
+				CreateAsteroid(world, SMALL_ASTEROID, def);
+			}
+		}
+	private:
+		static constexpr unsigned NUM_ASTEROIDS{ 600 };
+		WrapMode m_wrapMode;
+	};
+
+	//+------------------------\----------------------------------
+	//|		   Running		   |
+	//\------------------------/----------------------------------
+	struct Result
+	{
+		std::string name;
+		unsigned numSteps{};
+		double totalSeconds{};
+		std::vector<double> stepMilliseconds;
+		EntityID peakEntityCount{};
+		ParticleID peakParticleCount{};
+		unsigned allocatingStepCount{};
+		WrapMode wrapMode{};
+		double physicsStepMilliseconds{};
+		unsigned peakCloneBodyCount{};
+	};
+
+	// Runs the scenario's steps one at a time. Update may take no step or two when the
+	// accumulator rounds, so time is charged to the steps actually taken.
+	Result Run(Scenario& scenario, unsigned numSteps, const WorldDef& fileSettings, unsigned seed)
+	{
+		// d2d's random functions draw from std::rand. Seeding per scenario keeps
+		// each one's layout the same whether it runs alone or after the others.
+		std::srand(seed);
+
+		WorldDef settings{ fileSettings };
+		scenario.AdjustSettings(settings);
+		float stepTime{ 1.0f / settings.stepsPerSecond };
+
+		auto worldPtr{ std::make_unique<World>() };
+		World& world{ *worldPtr };
+		d2d::Rect worldRect;
+		worldRect.SetCenter(b2Vec2_zero, WORLD_DIMENSIONS);
+		world.Init(worldRect, settings);
+		scenario.SetUp(world);
+
+		PlayerController playerController;
+		auto runSteps = [&](unsigned count, Result* resultPtr)
+		{
+			unsigned endStep{ world.GetUpdateStepCount() + count };
+			std::chrono::steady_clock::duration unchargedTime{};
+			while(world.GetUpdateStepCount() < endStep)
+			{
+				scenario.BeforeStep(world, playerController);
+				unsigned stepCountBefore{ world.GetUpdateStepCount() };
+				auto startTime{ std::chrono::steady_clock::now() };
+				world.Update(stepTime, playerController);
+				unchargedTime += std::chrono::steady_clock::now() - startTime;
+
+				unsigned numStepsTaken{ world.GetUpdateStepCount() - stepCountBefore };
+				if(!resultPtr || numStepsTaken == 0)
+					continue;
+				double milliseconds{ std::chrono::duration<double, std::milli>{ unchargedTime }.count() };
+				for(unsigned i = 0; i < numStepsTaken; ++i)
+					resultPtr->stepMilliseconds.push_back(milliseconds / numStepsTaken);
+				resultPtr->totalSeconds += milliseconds / 1000.0;
+				unchargedTime = {};
+				resultPtr->peakEntityCount = std::max(resultPtr->peakEntityCount, world.GetEntityCount());
+				resultPtr->peakParticleCount = std::max(resultPtr->peakParticleCount, world.GetParticleCount());
+				resultPtr->peakCloneBodyCount = std::max(resultPtr->peakCloneBodyCount, world.GetCloneBodyCount());
+			}
+		};
+
+		// Let containers and pools grow before measuring
+		runSteps(WARM_UP_STEPS, nullptr);
+		unsigned allocatingStepCountBefore{ world.GetAllocatingStepCount() };
+		double physicsStepSecondsBefore{ world.GetPhysicsStepSeconds() };
+		unsigned physicsStepCountBefore{ world.GetPhysicsStepCount() };
+
+		Result result;
+		result.name = scenario.GetName();
+		result.wrapMode = world.GetWrapMode();
+		result.stepMilliseconds.reserve(numSteps + 1);
+		runSteps(numSteps, &result);
+		result.numSteps = (unsigned)result.stepMilliseconds.size();
+		result.allocatingStepCount = world.GetAllocatingStepCount() - allocatingStepCountBefore;
+
+		// Physics alone, to compare wrap modes without the other systems
+		unsigned numPhysicsSteps{ world.GetPhysicsStepCount() - physicsStepCountBefore };
+		if(numPhysicsSteps > 0)
+			result.physicsStepMilliseconds = (world.GetPhysicsStepSeconds() - physicsStepSecondsBefore) * 1000.0 / numPhysicsSteps;
+		return result;
+	}
+	double GetPercentile(const std::vector<double>& sortedValues, double percentile)
+	{
+		if(sortedValues.empty())
+			return 0.0;
+		size_t index{ (size_t)std::ceil(percentile / 100.0 * sortedValues.size()) };
+		return sortedValues[std::clamp<size_t>(index, 1, sortedValues.size()) - 1];
+	}
+	void PrintJSON(const std::vector<Result>& results, float stepsPerSecond, unsigned seed)
+	{
+		std::cout << std::fixed << std::setprecision(4)
+			<< "{" << std::endl
+			<< "  \"simulatedStepsPerSecond\": " << stepsPerSecond << "," << std::endl
+			<< "  \"seed\": " << seed << "," << std::endl
+			<< "  \"allocationCounting\": " << (IsAllocationCountingEnabled() ? "true" : "false") << "," << std::endl
+			<< "  \"scenarios\": [" << std::endl;
+		for(size_t i = 0; i < results.size(); ++i)
+		{
+			const Result& result{ results[i] };
+			std::vector<double> sorted{ result.stepMilliseconds };
+			std::sort(sorted.begin(), sorted.end());
+			double mean{ sorted.empty() ? 0.0 : result.totalSeconds * 1000.0 / sorted.size() };
+			std::cout << "    {" << std::endl
+				<< "      \"name\": \"" << result.name << "\"," << std::endl
+				<< "      \"steps\": " << result.numSteps << "," << std::endl
+				<< "      \"stepsPerSecond\": " << (result.totalSeconds > 0.0 ? result.numSteps / result.totalSeconds : 0.0) << "," << std::endl
+				<< "      \"stepMilliseconds\": { "
+				<< "\"mean\": " << mean
+				<< ", \"p50\": " << GetPercentile(sorted, 50.0)
+				<< ", \"p90\": " << GetPercentile(sorted, 90.0)
+				<< ", \"p99\": " << GetPercentile(sorted, 99.0)
+				<< ", \"max\": " << (sorted.empty() ? 0.0 : sorted.back()) << " }," << std::endl
+				<< "      \"wrapMode\": \"" << (result.wrapMode == WrapMode::CLONES ? "clones" : "teleport") << "\"," << std::endl
+				<< "      \"collisionsAcrossEdge\": " << (result.wrapMode == WrapMode::CLONES ? "true" : "false") << "," << std::endl
+				<< "      \"physicsStepMilliseconds\": " << result.physicsStepMilliseconds << "," << std::endl
+				<< "      \"peakEntities\": " << result.peakEntityCount << "," << std::endl
+				<< "      \"peakCloneBodies\": " << result.peakCloneBodyCount << "," << std::endl
+				<< "      \"peakParticles\": " << result.peakParticleCount << "," << std::endl
+				<< "      \"allocatingSteps\": " << result.allocatingStepCount << std::endl
+				<< "    }" << (i + 1 < results.size() ? "," : "") << std::endl;
+		}
+		std::cout << "  ]" << std::endl
+			<< "}" << std::endl;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned numSteps{ DEFAULT_NUM_STEPS };
+	unsigned seed{ DEFAULT_SEED };
+	std::string onlyScenario;
+	bool failOnAllocation{ false };
+	unsigned numPositionalArgs{ 0 };
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg{ argv[i] };
+		if(arg == "--fail-on-alloc")
+			failOnAllocation = true;
+		else if(arg == "--seed" && i + 1 < argc)
+			seed = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+		else if(numPositionalArgs++ == 0)
+			numSteps = (unsigned)std::max(1, std::atoi(argv[i]));
+		else
+			onlyScenario = arg;
+	}
+
+	int exitCode{ EXIT_SUCCESS };
+	d2d::Init(d2LogSeverityTrace, "SpaceBench.log");
+	try
+	{
+		WorldDef settings;
+		settings.LoadFrom("Data/world.hjson");
+
+		DenseAsteroidField denseAsteroidField;
+		SustainedFire sustainedFire;
+		SustainedFire sustainedRayFire{ true };
+		MassExplosions massExplosions;
+		EdgeWrappingSwarm edgeWrappingSwarm{ WrapMode::CLONES };
+		EdgeWrappingSwarm teleportingSwarm{ WrapMode::TELEPORT };
+		std::array<Scenario*, 6> scenarios{ &denseAsteroidField, &sustainedFire, &sustainedRayFire, &massExplosions,
+			&edgeWrappingSwarm, &teleportingSwarm };
+
+		std::vector<Result> results;
+		for(Scenario* scenarioPtr : scenarios)
+			if(onlyScenario.empty() || onlyScenario == scenarioPtr->GetName())
+				results.push_back(Run(*scenarioPtr, numSteps, settings, seed));
+		if(results.empty())
+		{
+			std::cerr << "Unknown scenario: " << onlyScenario << std::endl;
+			exitCode = EXIT_FAILURE;
+		}
+		else
+			PrintJSON(results, settings.stepsPerSecond, seed);
+
+		if(failOnAllocation)
+		{
+			if(!IsAllocationCountingEnabled())
+				std::cerr << "space_bench: --fail-on-alloc has no effect, allocations are only counted in debug builds" << std::endl;
+			for(const Result& result : results)
+				if(result.allocatingStepCount > 0)
+				{
+					std::cerr << "space_bench: " << result.name << " allocated in " << result.allocatingStepCount
+						<< " of " << result.numSteps << " measured steps" << std::endl;
+					exitCode = EXIT_FAILURE;
+				}
+		}
+	}
+	catch(const std::exception& e)
+	{
+		std::cerr << "space_bench: " << e.what() << std::endl;
+		exitCode = EXIT_FAILURE;
+	}
+	d2d::Shutdown();
+	return exitCode;
+}
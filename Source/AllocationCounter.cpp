@@ -0,0 +1,71 @@
+/**************************************************************************************\
+** File: AllocationCounter.cpp
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Source code file for the heap allocation counter
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "AllocationCounter.h"
+#include <new>
+#include <cstdlib>
+
+#if !defined(NDEBUG)
+	#define SPACE_COUNT_ALLOCATIONS 1
+#else
+	#define SPACE_COUNT_ALLOCATIONS 0
+#endif
+
+namespace
+{
+	std::atomic<uint64_t> g_allocationCount{ 0 };
+}
+namespace Space
+{
+	bool IsAllocationCountingEnabled()
+	{
+		return SPACE_COUNT_ALLOCATIONS;
+	}
+	uint64_t GetAllocationCount()
+	{
+		return g_allocationCount.load(std::memory_order_relaxed);
+	}
+}
+
+#if SPACE_COUNT_ALLOCATIONS
+// The array and nothrow forms of new and all forms of delete forward to these by default
+void* operator new(std::size_t size)
+{
+	g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if(void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc{};
+}
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+	std::size_t align{ static_cast<std::size_t>(alignment) };
+#ifdef _MSC_VER
+	if(void* p = _aligned_malloc(size ? size : 1, align))
+		return p;
+#else
+	if(void* p = std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align))
+		return p;
+#endif
+	throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept
+{
+#ifdef _MSC_VER
+	_aligned_free(p);
+#else
+	std::free(p);
+#endif
+}
+#endif
@@ -0,0 +1,17 @@
+/**************************************************************************************\
+** File: AllocationCounter.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the heap allocation counter
+**
+\**************************************************************************************/
+#pragma once
+namespace Space
+{
+	// Debug builds replace the global operator new to count every heap allocation
+	// made by any thread. Release builds leave operator new alone and the count stays 0.
+	bool IsAllocationCountingEnabled();
+	uint64_t GetAllocationCount();
+}
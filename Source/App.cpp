@@ -17,6 +17,7 @@
 #include "Exceptions.h"
 #include "CameraSettings.h"
 #include "StarfieldSettings.h"
+#include "Trace.h"
 
 namespace Space
 {
@@ -44,6 +45,10 @@ namespace Space
 			d2d::InitGamepads(settings.gamepads);
 			d2d::Window::Init(settings.window);
 			m_hasFocus = false;
+
+			m_traceFilePath = settings.trace.filePath;
+			if(settings.trace.enabled)
+				StartTracing(settings.trace.eventCapacity);
 		}
 		d2d::SeedRandomNumberGenerator();
 
@@ -79,6 +84,7 @@ namespace Space
 	}
 	void App::Step(float dt)
 	{
+		TraceScope trace{ "App::Step" };
 		d2d::ClampHigh(dt, MAX_APP_STEP);
 
 		AppStateID nextStateID = Update(dt);
@@ -96,6 +102,7 @@ namespace Space
 	}
 	void App::StartState(AppStateID newStateID)
 	{
+		TraceScope trace{ "App::StartState", "state", (int)newStateID };
 		try
 		{
 			m_currentStateID = newStateID;
@@ -129,6 +136,10 @@ namespace Space
 			{
 			case SDL_QUIT:
 				return AppStateID::QUIT;
+			case SDL_KEYDOWN:
+				if(event.key.keysym.sym == TRACE_WRITE_KEY && IsTracing())
+					WriteTrace(m_traceFilePath);
+				break;
 			case SDL_WINDOWEVENT:
 				switch(event.window.event)
 				{
@@ -171,6 +182,12 @@ namespace Space
 	}
 	void App::Shutdown()
 	{
+		// Runs twice if an exception ends the main loop, so only write once
+		if(IsTracing())
+		{
+			WriteTrace(m_traceFilePath);
+			StopTracing();
+		}
 		d2d::Shutdown();
 	}
 }
@@ -18,6 +18,7 @@ namespace Space
 {
 	const AppStateID FIRST_APP_STATE = AppStateID::INTRO;
 	const float MAX_APP_STEP = 1.0f;
+	const SDL_Keycode TRACE_WRITE_KEY{ SDLK_F10 };
 
 	class App
 	{
@@ -38,6 +39,7 @@ namespace Space
 		AppStateID m_currentStateID{ FIRST_APP_STATE };
 
 		bool m_hasFocus{ false };
+		std::string m_traceFilePath;
 		Camera m_camera;
 		Starfield m_starfield;
 	};
@@ -41,9 +41,11 @@ namespace Space
 		// Get root level values
 		d2d::HjsonValue gamepadsData;
 		d2d::HjsonValue windowData;
+		d2d::HjsonValue traceData;
 		try {
 			gamepadsData = d2d::GetMemberValue(data, "gamepads");
 			windowData = d2d::GetMemberValue(data, "window");
+			traceData = d2d::GetMemberValue(data, "trace");
 		}
 		catch(const d2d::HjsonFailedQueryException& e) {
 			throw LoadSettingsFileException{ appFilePath + ": Invalid value: " + e.what() };
@@ -103,6 +105,16 @@ namespace Space
 			throw LoadSettingsFileException{ appFilePath + ": Invalid value: window." + e.what() };
 		}
 
+		// Get trace settings
+		try {
+			trace.enabled = d2d::GetBool(traceData, "enabled");
+			trace.eventCapacity = d2d::GetInt(traceData, "eventCapacity");
+			trace.filePath = d2d::GetString(traceData, "filePath");
+		}
+		catch(const d2d::HjsonFailedQueryException& e) {
+			throw LoadSettingsFileException{ appFilePath + ": Invalid value: trace." + e.what() };
+		}
+
 		try {
 			Validate();
 		}
@@ -136,5 +148,9 @@ namespace Space
 		// gl
 		if(window.gl.versionMajor < 0) throw SettingOutOfRangeException{ "window.glVersion[0]" };
 		if(window.gl.versionMinor < 0) throw SettingOutOfRangeException{ "window.glVersion[1]" };
+
+		// trace
+		if(trace.eventCapacity <= 0) throw SettingOutOfRangeException{ "trace.eventCapacity" };
+		if(trace.filePath.empty()) throw SettingOutOfRangeException{ "trace.filePath" };
 	}
 }
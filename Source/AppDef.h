@@ -10,6 +10,12 @@
 #pragma once
 namespace Space
 {
+	struct TraceDef
+	{
+		bool enabled{ false };
+		int eventCapacity{ 0 };
+		std::string filePath;
+	};
 	struct AppDef
 	{
 		void LoadFrom(const std::string& filePath);
@@ -17,5 +23,6 @@ namespace Space
 
 		d2d::GamepadSettings gamepads;
 		d2d::WindowDef window;
+		TraceDef trace;
 	};
 }
@@ -0,0 +1,151 @@
+/**************************************************************************************\
+** File: B2Allocator.cpp
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Source code file for the Box2D memory allocator
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "B2Allocator.h"
+#include <cstdlib>
+
+namespace Space
+{
+	namespace
+	{
+		// Every block starts with a header so b2Free knows where it came from.
+		// The header is a whole alignment unit so the memory after it stays aligned.
+		const size_t ALIGNMENT{ 16 };
+		struct alignas(ALIGNMENT) BlockHeader
+		{
+			size_t size;			// requested size
+			uint32_t sizeClass;		// LARGE if from malloc
+			BlockHeader* nextFree;
+		};
+		static_assert(sizeof(BlockHeader) % ALIGNMENT == 0);
+
+		// Payload sizes 64, 128, ... 16KB
+		const size_t MIN_CLASS_SIZE{ 64 };
+		const unsigned NUM_SIZE_CLASSES{ 9 };
+		const size_t MAX_CLASS_SIZE{ MIN_CLASS_SIZE << (NUM_SIZE_CLASSES - 1) };
+		const uint32_t LARGE{ std::numeric_limits<uint32_t>::max() };
+		const size_t ARENA_BLOCK_SIZE{ 1024 * 1024 };
+
+		unsigned GetSizeClass(size_t size)
+		{
+			unsigned sizeClass{ 0 };
+			while((MIN_CLASS_SIZE << sizeClass) < size)
+				++sizeClass;
+			return sizeClass;
+		}
+
+		struct Arena
+		{
+			std::vector<char*> blocks;
+			size_t blockIndex{ 0 };
+			size_t offset{ 0 };
+			std::array<BlockHeader*, NUM_SIZE_CLASSES> freeLists{};
+			B2MemoryStats stats;
+			unsigned liveCount{ 0 };
+
+			~Arena()
+			{
+				for(char* block : blocks)
+					std::free(block);
+			}
+			// Carves a new block for the size class from the current arena block
+			BlockHeader* Carve(unsigned sizeClass)
+			{
+				size_t blockSize{ sizeof(BlockHeader) + (MIN_CLASS_SIZE << sizeClass) };
+				if(blockIndex < blocks.size() && offset + blockSize > ARENA_BLOCK_SIZE)
+				{
+					++blockIndex;
+					offset = 0;
+				}
+				if(blockIndex == blocks.size())
+				{
+					char* block{ static_cast<char*>(std::malloc(ARENA_BLOCK_SIZE)) };
+					if(!block)
+						throw std::bad_alloc{};
+					blocks.push_back(block);
+					stats.arenaBytes += ARENA_BLOCK_SIZE;
+				}
+				BlockHeader* headerPtr{ reinterpret_cast<BlockHeader*>(blocks[blockIndex] + offset) };
+				offset += blockSize;
+				return headerPtr;
+			}
+		};
+		Arena& GetArena()
+		{
+			static Arena arena;
+			return arena;
+		}
+	}
+
+	B2MemoryStats GetB2MemoryStats()
+	{
+		return GetArena().stats;
+	}
+	void ResetB2MemoryLevel()
+	{
+		Arena& arena{ GetArena() };
+		d2Assert(arena.liveCount == 0 && "Box2D still holds memory");
+		arena.blockIndex = 0;
+		arena.offset = 0;
+		arena.freeLists.fill(nullptr);
+		arena.stats = B2MemoryStats{ .arenaBytes{ arena.blocks.size() * ARENA_BLOCK_SIZE } };
+	}
+}
+
+using namespace Space;
+void* b2Alloc_Space(int32 size)
+{
+	Arena& arena{ GetArena() };
+	size_t requestedSize{ (size_t)std::max(size, 1) };
+	BlockHeader* headerPtr;
+	if(requestedSize <= MAX_CLASS_SIZE)
+	{
+		unsigned sizeClass{ GetSizeClass(requestedSize) };
+		headerPtr = arena.freeLists[sizeClass];
+		if(headerPtr)
+			arena.freeLists[sizeClass] = headerPtr->nextFree;
+		else
+			headerPtr = arena.Carve(sizeClass);
+		headerPtr->sizeClass = sizeClass;
+	}
+	else
+	{
+		headerPtr = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + requestedSize));
+		if(!headerPtr)
+			throw std::bad_alloc{};
+		headerPtr->sizeClass = LARGE;
+		++arena.stats.largeAllocationCount;
+	}
+	headerPtr->size = requestedSize;
+	headerPtr->nextFree = nullptr;
+
+	++arena.liveCount;
+	++arena.stats.allocationCount;
+	arena.stats.bytes += requestedSize;
+	arena.stats.peakBytes = std::max(arena.stats.peakBytes, arena.stats.bytes);
+	return headerPtr + 1;
+}
+void b2Free_Space(void* mem)
+{
+	if(!mem)
+		return;
+	Arena& arena{ GetArena() };
+	BlockHeader* headerPtr{ static_cast<BlockHeader*>(mem) - 1 };
+	d2Assert(arena.liveCount > 0);
+	--arena.liveCount;
+	arena.stats.bytes -= headerPtr->size;
+	if(headerPtr->sizeClass == LARGE)
+		std::free(headerPtr);
+	else
+	{
+		headerPtr->nextFree = arena.freeLists[headerPtr->sizeClass];
+		arena.freeLists[headerPtr->sizeClass] = headerPtr;
+	}
+}
@@ -0,0 +1,31 @@
+/**************************************************************************************\
+** File: B2Allocator.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the Box2D memory allocator
+**
+\**************************************************************************************/
+#pragma once
+namespace Space
+{
+	struct B2MemoryStats
+	{
+		size_t bytes{};					// requested by Box2D and not yet freed
+		size_t peakBytes{};
+		unsigned allocationCount{};
+		unsigned largeAllocationCount{};	// too big for the pools, passed to malloc
+		size_t arenaBytes{};			// reserved for the pools
+	};
+
+	// b2Alloc and b2Free (b2_user_settings.h) come here. Blocks up to 16KB, which
+	// covers the chunks of Box2D's own small block allocator, come from size-class
+	// free lists carved out of a level arena. Not thread safe: only call Box2D
+	// from systems that write RESOURCE_B2WORLD.
+	B2MemoryStats GetB2MemoryStats();
+
+	// Takes back all arena memory at once. Call only after the b2World is deleted,
+	// when Box2D no longer holds any blocks. Arena blocks are kept for the next level.
+	void ResetB2MemoryLevel();
+}
@@ -0,0 +1,222 @@
+/**************************************************************************************\
+** File: BodyStateCache.cpp
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Source code file for the BodyStateCache class
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "BodyStateCache.h"
+
+#if defined(__AVX__)
+	#define SPACE_BODY_STATE_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SPACE_BODY_STATE_SIMD_WIDTH 4
+#else
+	#define SPACE_BODY_STATE_SIMD_WIDTH 1
+#endif
+#if SPACE_BODY_STATE_SIMD_WIDTH > 1
+	#include <immintrin.h>
+#endif
+
+namespace Space
+{
+	void BodyStateCache::Store(EntityID entityID, b2Body* b2BodyPtr)
+	{
+		d2Assert(b2BodyPtr);
+		if(!Contains(entityID))
+		{
+			EntityID slot{ GetEntityIndex(entityID) };
+			if(slot >= m_indices.size())
+				m_indices.resize(slot + 1, INVALID_INDEX);
+			m_indices[slot] = m_entityIDs.size();
+			m_entityIDs.push_back(entityID);
+			m_b2BodyPtrs.push_back(nullptr);
+			m_positionsX.push_back(0.0f);
+			m_positionsY.push_back(0.0f);
+			m_angles.push_back(0.0f);
+			m_sines.push_back(0.0f);
+			m_cosines.push_back(1.0f);
+			m_centersX.push_back(0.0f);
+			m_centersY.push_back(0.0f);
+			m_velocitiesX.push_back(0.0f);
+			m_velocitiesY.push_back(0.0f);
+			m_angularVelocities.push_back(0.0f);
+		}
+		size_t index{ GetIndex(entityID) };
+		m_b2BodyPtrs[index] = b2BodyPtr;
+		CopyBody(index);
+	}
+	void BodyStateCache::Erase(EntityID entityID)
+	{
+		if(!Contains(entityID))
+			return;
+
+		size_t index{ GetIndex(entityID) };
+		size_t lastIndex{ m_entityIDs.size() - 1 };
+		if(index != lastIndex)
+		{
+			m_entityIDs[index] = m_entityIDs[lastIndex];
+			m_b2BodyPtrs[index] = m_b2BodyPtrs[lastIndex];
+			m_positionsX[index] = m_positionsX[lastIndex];
+			m_positionsY[index] = m_positionsY[lastIndex];
+			m_angles[index] = m_angles[lastIndex];
+			m_sines[index] = m_sines[lastIndex];
+			m_cosines[index] = m_cosines[lastIndex];
+			m_centersX[index] = m_centersX[lastIndex];
+			m_centersY[index] = m_centersY[lastIndex];
+			m_velocitiesX[index] = m_velocitiesX[lastIndex];
+			m_velocitiesY[index] = m_velocitiesY[lastIndex];
+			m_angularVelocities[index] = m_angularVelocities[lastIndex];
+			m_indices[GetEntityIndex(m_entityIDs[index])] = index;
+		}
+		m_entityIDs.pop_back();
+		m_b2BodyPtrs.pop_back();
+		m_positionsX.pop_back();
+		m_positionsY.pop_back();
+		m_angles.pop_back();
+		m_sines.pop_back();
+		m_cosines.pop_back();
+		m_centersX.pop_back();
+		m_centersY.pop_back();
+		m_velocitiesX.pop_back();
+		m_velocitiesY.pop_back();
+		m_angularVelocities.pop_back();
+		m_indices[GetEntityIndex(entityID)] = INVALID_INDEX;
+	}
+	void BodyStateCache::Clear()
+	{
+		m_indices.clear();
+		m_entityIDs.clear();
+		m_b2BodyPtrs.clear();
+		m_positionsX.clear();
+		m_positionsY.clear();
+		m_angles.clear();
+		m_sines.clear();
+		m_cosines.clear();
+		m_centersX.clear();
+		m_centersY.clear();
+		m_velocitiesX.clear();
+		m_velocitiesY.clear();
+		m_angularVelocities.clear();
+	}
+	void BodyStateCache::RefreshAll()
+	{
+		for(size_t i = 0; i < m_entityIDs.size(); ++i)
+			CopyBody(i);
+	}
+	void BodyStateCache::Translate(EntityID entityID, const b2Vec2& translation)
+	{
+		size_t index{ GetIndex(entityID) };
+		m_positionsX[index] += translation.x;
+		m_positionsY[index] += translation.y;
+		m_centersX[index] += translation.x;
+		m_centersY[index] += translation.y;
+	}
+	bool BodyStateCache::Contains(EntityID entityID) const
+	{
+		EntityID slot{ GetEntityIndex(entityID) };
+		return slot < m_indices.size() && m_indices[slot] != INVALID_INDEX &&
+			m_entityIDs[m_indices[slot]] == entityID;
+	}
+	b2Vec2 BodyStateCache::GetPosition(EntityID entityID) const
+	{
+		size_t index{ GetIndex(entityID) };
+		return { m_positionsX[index], m_positionsY[index] };
+	}
+	float BodyStateCache::GetAngle(EntityID entityID) const
+	{
+		return m_angles[GetIndex(entityID)];
+	}
+	b2Transform BodyStateCache::GetTransform(EntityID entityID) const
+	{
+		return GetTransformAt(GetIndex(entityID));
+	}
+	b2Vec2 BodyStateCache::GetWorldCenter(EntityID entityID) const
+	{
+		size_t index{ GetIndex(entityID) };
+		return { m_centersX[index], m_centersY[index] };
+	}
+	b2Vec2 BodyStateCache::GetLinearVelocity(EntityID entityID) const
+	{
+		size_t index{ GetIndex(entityID) };
+		return { m_velocitiesX[index], m_velocitiesY[index] };
+	}
+	float BodyStateCache::GetAngularVelocity(EntityID entityID) const
+	{
+		return m_angularVelocities[GetIndex(entityID)];
+	}
+	void BodyStateCache::GetEntitiesOutside(const d2d::Rect& rect, std::vector<EntityID>& entityIDsOut) const
+	{
+		entityIDsOut.clear();
+		size_t count{ m_entityIDs.size() };
+		size_t i = 0;
+#if SPACE_BODY_STATE_SIMD_WIDTH == 8
+		__m256 left{ _mm256_set1_ps(rect.lowerBound.x) };
+		__m256 right{ _mm256_set1_ps(rect.upperBound.x) };
+		__m256 bottom{ _mm256_set1_ps(rect.lowerBound.y) };
+		__m256 top{ _mm256_set1_ps(rect.upperBound.y) };
+		for(; i + 8 <= count; i += 8)
+		{
+			__m256 x{ _mm256_loadu_ps(m_positionsX.data() + i) };
+			__m256 y{ _mm256_loadu_ps(m_positionsY.data() + i) };
+			__m256 outside{ _mm256_or_ps(
+				_mm256_or_ps(_mm256_cmp_ps(x, left, _CMP_LT_OQ), _mm256_cmp_ps(x, right, _CMP_GT_OQ)),
+				_mm256_or_ps(_mm256_cmp_ps(y, bottom, _CMP_LT_OQ), _mm256_cmp_ps(y, top, _CMP_GT_OQ))) };
+			for(int mask = _mm256_movemask_ps(outside); mask != 0; mask &= mask - 1)
+				entityIDsOut.push_back(m_entityIDs[i + std::countr_zero((unsigned)mask)]);
+		}
+#elif SPACE_BODY_STATE_SIMD_WIDTH == 4
+		__m128 left{ _mm_set1_ps(rect.lowerBound.x) };
+		__m128 right{ _mm_set1_ps(rect.upperBound.x) };
+		__m128 bottom{ _mm_set1_ps(rect.lowerBound.y) };
+		__m128 top{ _mm_set1_ps(rect.upperBound.y) };
+		for(; i + 4 <= count; i += 4)
+		{
+			__m128 x{ _mm_loadu_ps(m_positionsX.data() + i) };
+			__m128 y{ _mm_loadu_ps(m_positionsY.data() + i) };
+			__m128 outside{ _mm_or_ps(
+				_mm_or_ps(_mm_cmplt_ps(x, left), _mm_cmpgt_ps(x, right)),
+				_mm_or_ps(_mm_cmplt_ps(y, bottom), _mm_cmpgt_ps(y, top))) };
+			for(int mask = _mm_movemask_ps(outside); mask != 0; mask &= mask - 1)
+				entityIDsOut.push_back(m_entityIDs[i + std::countr_zero((unsigned)mask)]);
+		}
+#endif
+		for(; i < count; ++i)
+			if(m_positionsX[i] < rect.lowerBound.x || m_positionsX[i] > rect.upperBound.x ||
+				m_positionsY[i] < rect.lowerBound.y || m_positionsY[i] > rect.upperBound.y)
+				entityIDsOut.push_back(m_entityIDs[i]);
+	}
+	size_t BodyStateCache::GetIndex(EntityID entityID) const
+	{
+		d2Assert(Contains(entityID));
+		return m_indices[GetEntityIndex(entityID)];
+	}
+	void BodyStateCache::CopyBody(size_t index)
+	{
+		const b2Body& b2Body{ *m_b2BodyPtrs[index] };
+		const b2Transform& transform{ b2Body.GetTransform() };
+		const b2Vec2& center{ b2Body.GetWorldCenter() };
+		const b2Vec2& velocity{ b2Body.GetLinearVelocity() };
+		m_positionsX[index] = transform.p.x;
+		m_positionsY[index] = transform.p.y;
+		m_angles[index] = b2Body.GetAngle();
+		m_sines[index] = transform.q.s;
+		m_cosines[index] = transform.q.c;
+		m_centersX[index] = center.x;
+		m_centersY[index] = center.y;
+		m_velocitiesX[index] = velocity.x;
+		m_velocitiesY[index] = velocity.y;
+		m_angularVelocities[index] = b2Body.GetAngularVelocity();
+	}
+	b2Transform BodyStateCache::GetTransformAt(size_t index) const
+	{
+		b2Transform transform;
+		transform.p.Set(m_positionsX[index], m_positionsY[index]);
+		transform.q.s = m_sines[index];
+		transform.q.c = m_cosines[index];
+		return transform;
+	}
+}
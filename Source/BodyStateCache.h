@@ -0,0 +1,75 @@
+/**************************************************************************************\
+** File: BodyStateCache.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the BodyStateCache class
+**
+\**************************************************************************************/
+#pragma once
+#include "Components.h"
+namespace Space
+{
+	//+---------------------------------------------\
+	//|  BodyStateCache: main body state as arrays  |
+	//\---------------------------------------------/
+	// Position, rotation, center of mass and velocities of every main body,
+	// kept packed in float arrays so passes over all bodies don't have to
+	// visit each b2Body. RefreshAll copies every body after b2World::Step;
+	// anything that moves a body or changes its velocity between steps must
+	// Store that entity again, or Translate it if it was only moved by a known
+	// offset. Erase swaps the last entry into the hole, so indices are only
+	// good until the next Store or Erase.
+	class BodyStateCache
+	{
+	public:
+		// Adds the entity or refreshes its entry
+		void Store(EntityID entityID, b2Body* b2BodyPtr);
+		void Erase(EntityID entityID);
+		void Clear();
+		void RefreshAll();
+
+		// Moves the cached position and center, for a body that was moved by translation
+		void Translate(EntityID entityID, const b2Vec2& translation);
+
+		bool Contains(EntityID entityID) const;
+		size_t Size() const { return m_entityIDs.size(); }
+		b2Vec2 GetPosition(EntityID entityID) const;
+		float GetAngle(EntityID entityID) const;
+		b2Transform GetTransform(EntityID entityID) const;
+		b2Vec2 GetWorldCenter(EntityID entityID) const;
+		b2Vec2 GetLinearVelocity(EntityID entityID) const;
+		float GetAngularVelocity(EntityID entityID) const;
+
+		// By index, for passes over every body, 0 <= index < Size()
+		EntityID GetEntityIDAt(size_t index) const { return m_entityIDs[index]; }
+		b2Vec2 GetPositionAt(size_t index) const { return { m_positionsX[index], m_positionsY[index] }; }
+		b2Vec2 GetLinearVelocityAt(size_t index) const { return { m_velocitiesX[index], m_velocitiesY[index] }; }
+		b2Transform GetTransformAt(size_t index) const;
+
+		// Fills entityIDsOut with the entities whose position is outside rect.
+		// Tests several positions at once with SSE2 or AVX when available.
+		void GetEntitiesOutside(const d2d::Rect& rect, std::vector<EntityID>& entityIDsOut) const;
+
+	private:
+		static constexpr size_t INVALID_INDEX{ std::numeric_limits<size_t>::max() };
+		size_t GetIndex(EntityID entityID) const;
+		void CopyBody(size_t index);
+
+		// If you add more arrays, add them to Store(), Erase() and Clear()
+		std::vector<size_t> m_indices;
+		std::vector<EntityID> m_entityIDs;
+		std::vector<b2Body*> m_b2BodyPtrs;
+		std::vector<float> m_positionsX;
+		std::vector<float> m_positionsY;
+		std::vector<float> m_angles;
+		std::vector<float> m_sines;
+		std::vector<float> m_cosines;
+		std::vector<float> m_centersX;
+		std::vector<float> m_centersY;
+		std::vector<float> m_velocitiesX;
+		std::vector<float> m_velocitiesY;
+		std::vector<float> m_angularVelocities;
+	};
+}
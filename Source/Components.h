@@ -9,10 +9,31 @@
 \**************************************************************************************/
 #pragma once
 #include "Model.h"
+#include "TimerWheel.h"
 namespace Space
 {
 	using EntityID = size_t;
 
+	// An EntityID is a handle: the low half holds the slot index used to address
+	// per-entity storage, the high half holds the slot's generation. A slot's
+	// generation is odd while an entity lives in it and is bumped again when that
+	// entity is destroyed, so handles kept past destruction no longer match.
+	const unsigned ENTITY_INDEX_BITS{ sizeof(EntityID) * 4 };
+	const EntityID ENTITY_INDEX_MASK{ (EntityID{ 1 } << ENTITY_INDEX_BITS) - 1 };
+	const EntityID INVALID_ENTITY_ID{ 0 };
+	inline EntityID GetEntityIndex(EntityID entityID)
+	{
+		return entityID & ENTITY_INDEX_MASK;
+	}
+	inline EntityID GetEntityGeneration(EntityID entityID)
+	{
+		return entityID >> ENTITY_INDEX_BITS;
+	}
+	inline EntityID MakeEntityID(EntityID index, EntityID generation)
+	{
+		return ((generation & ENTITY_INDEX_MASK) << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK);
+	}
+
 	// Components have associated data
 	enum ComponentBit : size_t
 	{
@@ -75,7 +96,6 @@ namespace Space
 	};
 	struct DrawAnimationComponent
 	{
-		int layer;
 		d2d::Animation animation;
 	};
 	struct ProjectileDef
@@ -95,6 +115,10 @@ namespace Space
 		bool ignoreParentCollisionsUntilFirstContactEnd;
 		float acceleration;
 		float accelerationTime;
+
+		// Move as a point swept against the world each step instead of as a Box2D body.
+		// Such projectiles stop at their first hit and are not entities.
+		bool sweptRay{ false };
 		//float explosionMaxImpulse;
 		//float explosionImpulseRadius;
 		//const AnimationDef* explosionAnimationDefPtr{ nullptr };
@@ -162,10 +186,6 @@ namespace Space
 		bool crossedUpperBound;
 		bool requiresManualWrapping;
 	};
-	struct Fixture
-	{
-		bool isRadar{ false };
-	};
 	struct RotatorComponent
 	{
 		float factor;
@@ -187,8 +207,9 @@ namespace Space
 		float cooldownSeconds;
 
 		bool engaged;
-		float secondsLeft;
-		float cooldownSecondsLeft;
+		bool boosting;
+		bool coolingDown;
+		TimerID timerID;
 	};
 	struct ThrusterComponent
 	{
@@ -199,7 +220,7 @@ namespace Space
 	struct SetThrustFactorAfterDelayComponent
 	{
 		float factor;
-		float delay;
+		TimerID timerID;
 	};
 	struct FuelComponent
 	{
@@ -225,7 +246,8 @@ namespace Space
 		b2Vec2 localRelativePosition;
 		float impulse;
 		float interval;
-		float intervalAccumulator;
+		bool ready;
+		TimerID readyTimerID;
 	};
 	struct ProjectileLauncherComponent
 	{
@@ -244,7 +266,10 @@ namespace Space
 	struct RadarComponent
 	{
 		float range{};
-		std::map<Body*, unsigned> bodiesInRange;
-		b2Fixture* b2FixturePtr;
+
+		// Entities whose bounding circle was within range at the last refresh,
+		// sorted by ID, not including the radar's owner
+		std::vector<EntityID> entitiesInRange;
+		TimerID refreshTimerID{ INVALID_TIMER_ID };
 	};
 }
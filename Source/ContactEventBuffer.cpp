@@ -0,0 +1,60 @@
+/**************************************************************************************\
+** File: ContactEventBuffer.cpp
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Source code file for the ContactEventBuffer class
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "ContactEventBuffer.h"
+namespace Space
+{
+	void ContactEventBuffer::Init(size_t capacity)
+	{
+		d2Assert(capacity > 0);
+		m_events.resize(capacity);
+		Clear();
+		ResetCounts();
+	}
+	void ContactEventBuffer::Clear()
+	{
+		m_head = 0;
+		m_size = 0;
+	}
+	bool ContactEventBuffer::Push(const ContactEvent& event)
+	{
+		if(m_size == m_events.size())
+		{
+			++m_droppedCount;
+			return false;
+		}
+		size_t tail{ m_head + m_size };
+		if(tail >= m_events.size())
+			tail -= m_events.size();
+		m_events[tail] = event;
+		++m_size;
+		++m_counts[(size_t)event.type];
+		return true;
+	}
+	bool ContactEventBuffer::Pop(ContactEvent& eventOut)
+	{
+		if(m_size == 0)
+			return false;
+		eventOut = m_events[m_head];
+		if(++m_head == m_events.size())
+			m_head = 0;
+		--m_size;
+		return true;
+	}
+	void ContactEventBuffer::ResetCounts()
+	{
+		m_counts.fill(0);
+		m_droppedCount = 0;
+	}
+	unsigned ContactEventBuffer::GetCount(ContactEventType type) const
+	{
+		return m_counts[(size_t)type];
+	}
+}
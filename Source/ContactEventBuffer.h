@@ -0,0 +1,60 @@
+/**************************************************************************************\
+** File: ContactEventBuffer.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the ContactEventBuffer class
+**
+\**************************************************************************************/
+#pragma once
+#include "Components.h"
+namespace Space
+{
+	enum class ContactEventType : uint8_t
+	{
+		ICON_COLLECTED,		// entity 1 collected icon entity 2
+		IMPULSE,			// impulse solved between entities 1 and 2
+		END_CONTACT,		// entities 1 and 2 stopped touching
+		NUM_TYPES
+	};
+	struct ContactEvent
+	{
+		ContactEventType type;
+		bool isClone1;
+		bool isClone2;
+		EntityID entityID1;
+		EntityID entityID2;
+		float impulse{};
+		b2Vec2 normal{ 0.0f, 0.0f };
+	};
+
+	//+-----------------------------------------------\
+	//|  ContactEventBuffer: contacts after the step  |
+	//\-----------------------------------------------/
+	// Fixed-capacity ring buffer filled by the Box2D contact callbacks and
+	// emptied by World after the step. Storage is allocated once by Init;
+	// events pushed while the buffer is full are dropped and counted.
+	class ContactEventBuffer
+	{
+	public:
+		void Init(size_t capacity);
+		void Clear();
+		bool Push(const ContactEvent& event);
+		bool Pop(ContactEvent& eventOut);
+		bool IsEmpty() const { return m_size == 0; }
+		size_t Size() const { return m_size; }
+
+		// Events pushed, by type, and dropped since the last ResetCounts
+		void ResetCounts();
+		unsigned GetCount(ContactEventType type) const;
+		unsigned GetDroppedCount() const { return m_droppedCount; }
+
+	private:
+		std::vector<ContactEvent> m_events;
+		size_t m_head{ 0 };
+		size_t m_size{ 0 };
+		std::array<unsigned, (size_t)ContactEventType::NUM_TYPES> m_counts{};
+		unsigned m_droppedCount{ 0 };
+	};
+}
@@ -108,6 +108,7 @@ namespace Space::GUISettings {
 	namespace HUD::Text {
 		namespace Color {
 			const d2d::Color FPS{ 1.0f, 1.0f, 0.0f, 1.0f };
+			const d2d::Color PROFILER{ 0.6f, 1.0f, 0.6f, 0.9f };
 			const d2d::Color FUEL{ 1.0f, 0.2f, 0.2f, 1.0f };
 			const d2d::Color CREDITS{ 0.2f, 0.2f, 1.0f, 1.0f };
 			const d2d::Color LEVEL{1.0f, 1.0f, 0.2f, 1.0f};
@@ -116,6 +117,8 @@ namespace Space::GUISettings {
 		namespace Size {
 			const float DEFAULT = 0.035f;
 			const float FPS = DEFAULT;
+			const float PROFILER = 0.02f;
+			const float PROFILER_LINE_SPACING = 1.25f * PROFILER;
 			const float FUEL = DEFAULT;
 			const float CREDITS = DEFAULT;
 			const float LEVEL = DEFAULT;
@@ -124,6 +127,8 @@ namespace Space::GUISettings {
 		namespace Position {
 			const b2Vec2 FPS{ 0.99f, 0.99f };
 			const d2d::AlignmentAnchor FPS_ALIGNMENT{ d2d::AlignmentAnchorX::RIGHT, d2d::AlignmentAnchorY::TOP };
+			const b2Vec2 PROFILER{ 0.99f, 0.99f - 1.25f * Size::FPS };
+			const d2d::AlignmentAnchor PROFILER_ALIGNMENT{ d2d::AlignmentAnchorX::RIGHT, d2d::AlignmentAnchorY::TOP };
 			const b2Vec2 FUEL{ HUD::ViewSections::LEFT.GetCenterX(), 0.25f};
 			const d2d::AlignmentAnchor FUEL_ALIGNMENT{ d2d::AlignmentAnchorX::CENTER, d2d::AlignmentAnchorY::CENTER };
 			const b2Vec2 CREDITS{ HUD::ViewSections::LEFT.GetCenterX(), 0.5f };
@@ -24,6 +24,8 @@ namespace Space
 		m_world.SetWrapListener(this);
 		m_world.SetProjectileLauncherListener(this);
 		m_world.SetExitListener(this);
+		m_world.SetProfiler(&m_profiler);
+		m_drawHUDPhaseID = m_profiler.AddPhase("Game::DrawHUD");
 	}
 
 	//+-----------------\-----------------------------------------
@@ -46,7 +48,8 @@ namespace Space
 		m_cameraFollowingEntity = false;
 		m_player.isSet = false;
 		m_player.exited = false;
-		m_delayedGameActions.clear();
+		m_delayedGameActions.Clear();
+		m_delayedActionTime = 0.0f;
 		m_firstUpdate = true;
 
 		d2d::Rect worldRect;
@@ -59,6 +62,7 @@ namespace Space
 	//\--------------------------------/--------------------------
 	void Game::StartCurrentLevel()
 	{
+		TraceScope trace{ "Game::StartCurrentLevel", "level", (int)m_player.currentLevel };
 		ClearLevel({ 500.0f, 500.0f });
 		ValidateWorldDimensions();
 		try
@@ -93,6 +97,14 @@ namespace Space
 		return m_player.credits;
 	}
 
+	//+-----------------------\-----------------------------------
+	//|	     GetProfiler      |
+	//\-----------------------/-----------------------------------
+	const Profiler& Game::GetProfiler() const
+	{
+		return m_profiler;
+	}
+
 	//+-----------------------\-----------------------------------
 	//|	   PurchaseUpgrade    |
 	//\-----------------------/
@@ -234,33 +246,35 @@ namespace Space
 	//\--------------------------/--------------------------------
 	void Game::UpdateDelayedActions(float dt)
 	{
-		for(DelayedGameAction d : m_delayedGameActions)
-			d.timeElapsed += dt;
-
+		// Whole ticks only; the remainder carries over to the next update
 		bool startLevel = false;
-		for(auto it = m_delayedGameActions.begin(); it != m_delayedGameActions.end(); it++)
+		m_delayedActionTime += dt;
+		while(m_delayedActionTime >= DELAYED_ACTION_TICK_SECONDS)
 		{
-			it->timeElapsed += dt;
-			if(it->timeElapsed >= it->delay)
-			{
-				switch(it->action)
+			m_delayedActionTime -= DELAYED_ACTION_TICK_SECONDS;
+			m_delayedGameActions.Advance([&](TimerID, GameAction action)
 				{
-				case GameAction::NEXT_LEVEL:
-					m_player.currentLevel++;
-					startLevel = true;
-					break;
-				case GameAction::RESTART_LEVEL:
-					startLevel = true;
-					break;
-				}
-				it = m_delayedGameActions.erase(it);
-			}
+					switch(action)
+					{
+					case GameAction::NEXT_LEVEL:
+						m_player.currentLevel++;
+						startLevel = true;
+						break;
+					case GameAction::RESTART_LEVEL:
+						startLevel = true;
+						break;
+					}
+				});
 		}
 		if(startLevel)
 		{
 			StartCurrentLevel();
 		}
 	}
+	void Game::DelayAction(GameAction action, float delay)
+	{
+		m_delayedGameActions.Schedule((uint64_t)std::ceil(delay / DELAYED_ACTION_TICK_SECONDS), action);
+	}
 
 	//+--------------------------\--------------------------------
 	//|	      UpdateCamera		 | 
@@ -287,7 +301,7 @@ namespace Space
 			if(!m_player.exited)
 			{
 				m_player.credits -= DEATH_PENALTY_CREDITS;
-				//m_delayedGameActions.push_back({ .action{ GameAction::RESTART_LEVEL }, .delay{ LEVEL_CHANGE_DELAY } });
+				//DelayAction(GameAction::RESTART_LEVEL, LEVEL_CHANGE_DELAY);
 			}
 			m_player.isSet = false;
 		}
@@ -337,6 +351,7 @@ namespace Space
 	//\-------------/---------------------------------------------
 	void Game::DrawHUD()
 	{
+		ScopedTimer timer{ &m_profiler, m_drawHUDPhaseID };
 		b2Vec2 screenSize{ d2d::Window::GetScreenSize() };
 		int screenWidth, screenHeight;
 		d2d::Window::GetScreenSize(&screenWidth, &screenHeight);
@@ -410,7 +425,7 @@ namespace Space
 			d2d::Window::PushMatrix();
 			d2d::Window::Translate(position * screenSize);
 			{
-				std::string levelString = "Radar\n" + d2d::ToString(m_world.GetRadarComponent(m_player.id).bodiesInRange.size());
+				std::string levelString = "Radar\n" + d2d::ToString(m_world.GetEntitiesInRadarRange(m_player.id).size());
 				d2d::Window::DrawString(levelString, GUISettings::HUD::Text::Size::LEVEL * screenSize.y,
 					m_hudFont, alignment);
 			}
@@ -14,6 +14,7 @@
 #include "GameSettings.h"
 #include "EntityFactory.h"
 #include "ShopSettings.h"
+#include "Profiler.h"
 namespace Space
 {
 	enum class GameAction
@@ -21,12 +22,6 @@ namespace Space
 		NEXT_LEVEL,
 		RESTART_LEVEL
 	};
-	struct DelayedGameAction
-	{
-		GameAction action;
-		float delay{};
-		float timeElapsed{};
-	};
 
 	class Game
 		: public DestroyListener,
@@ -43,6 +38,7 @@ namespace Space
 		bool DidPlayerExit() const;
 		void StartCurrentLevel();
 		float GetPlayerCredits() const;
+		const Profiler& GetProfiler() const;
 
 		// Returns true if purchase was successful, otherwise returns false.
 		bool PurchaseUpgrade(ShopItemID itemID, float price = 0.0f);
@@ -59,6 +55,7 @@ namespace Space
 
 		void UpdateCamera(float dt, const PlayerController &playerController);
 		void UpdateDelayedActions(float dt);
+		void DelayAction(GameAction action, float delay);
 		void SetPlayer(EntityID entityID);
 		bool IsPlayer(EntityID entityID) const;
 		void ApplyPlayerUpgrades(World& world, EntityID playerID, const std::set<ShopItemID>& upgrades);
@@ -67,6 +64,8 @@ namespace Space
 		void DrawHUD();
 
 	private:
+		Profiler m_profiler;
+		ProfilerPhaseID m_drawHUDPhaseID{ INVALID_PROFILER_PHASE_ID };
 		World m_world;
 		EntityFactory m_factory;
 		Camera *const m_cameraPtr;
@@ -83,7 +82,8 @@ namespace Space
 			bool exited{};
 			std::set<ShopItemID> upgrades;
 		} m_player;
-		std::list<DelayedGameAction> m_delayedGameActions;
+		TimerWheel<GameAction> m_delayedGameActions;
+		float m_delayedActionTime{};
 		d2d::FontReference m_hudFont{"Fonts/OrbitronLight.otf"};
 	};
 }
@@ -68,6 +68,7 @@ namespace Space
 		{
 			const SDL_Keycode pauseKey{ SDLK_ESCAPE };
 			const SDL_Keycode fpsToggleKey{ SDLK_F12 };
+			const SDL_Keycode profilerToggleKey{ SDLK_F11 };
 			const SDL_Keycode zoomInKey{ SDLK_PAGEUP };
 			const SDL_Keycode zoomOutKey{ SDLK_PAGEDOWN };
 			const SDL_Keycode turnLeftKey{ SDLK_LEFT };
@@ -242,7 +242,8 @@ namespace Space
 			BULLET_DESTRUCTION_CHANCE,
 			BULLET_IGNORE_PARENT_COLLISIONS_UNTIL_FIRST_CONTACT,
 			BULLET_ACCELERATION,
-			BULLET_ACCELERATION_TIME };
+			BULLET_ACCELERATION_TIME,
+			BULLET_SWEPT_RAY };
 
 		// Missile
 		ProjectileDef missileDef{ missile,
@@ -259,7 +260,8 @@ namespace Space
 			MISSILE_DESTRUCTION_CHANCE,
 			MISSILE_IGNORE_PARENT_COLLISIONS_UNTIL_FIRST_CONTACT,
 			MISSILE_ACCELERATION,
-			MISSILE_ACCELERATION_TIME };
+			MISSILE_ACCELERATION_TIME,
+			MISSILE_SWEPT_RAY };
 
 		// Fat missile
 		ProjectileDef fatMissileDef{ fatMissile,
@@ -276,6 +278,7 @@ namespace Space
 			MISSILE_DESTRUCTION_CHANCE,
 			MISSILE_IGNORE_PARENT_COLLISIONS_UNTIL_FIRST_CONTACT,
 			MISSILE_ACCELERATION,
-			MISSILE_ACCELERATION_TIME };
+			MISSILE_ACCELERATION_TIME,
+			MISSILE_SWEPT_RAY };
 	};
 }
@@ -14,6 +14,7 @@ namespace Space
 	const int DEFAULT_DRAW_LAYER = 0;
 	const float MIN_WORLD_TO_CAMERA_RATIO = 1.5f;
 	const float LEVEL_CHANGE_DELAY = 3.0f;
+	const float DELAYED_ACTION_TICK_SECONDS = 0.01f;
 	const float DEATH_PENALTY_CREDITS = 5.0f;
 
 	// Relative entity heights
@@ -98,6 +99,8 @@ namespace Space
 	const float MISSILE_ACCELERATION = 20.0f;
 	const float BULLET_ACCELERATION_TIME = 0.0f;
 	const float MISSILE_ACCELERATION_TIME = 5.0f;
+	const bool BULLET_SWEPT_RAY = false;
+	const bool MISSILE_SWEPT_RAY = false;
 
 	// HP
 	const float BLASTER_HP = 200.0f;
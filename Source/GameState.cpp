@@ -14,6 +14,8 @@
 #include "ShopSettings.h"
 #include "GUISettings.h"
 #include "GUIStrings.h"
+#include <sstream>
+#include <iomanip>
 namespace Space
 {
 	void GameState::Init()
@@ -29,6 +31,7 @@ namespace Space
 		m_menu.SetButtonTextSize(GUISettings::Menu::Text::Size::BUTTON);
 
 		m_showFPS = false;
+		m_showProfiler = false;
 		ResetController();
 
 		m_shop.Init(ShopSettings::ROOM_LIST);
@@ -266,6 +269,8 @@ namespace Space
 		}
 		if(m_showFPS)
 			DrawFPS();
+		if(m_showProfiler)
+			DrawProfiler();
 	}
 	void GameState::DrawFPS()
 	{
@@ -285,6 +290,40 @@ namespace Space
 			m_HUDFont, GUISettings::HUD::Text::Position::FPS_ALIGNMENT);
 		d2d::Window::PopMatrix();
 	}
+	// One line per phase below the FPS counter: min / avg / p99 of its recent timings
+	void GameState::DrawProfiler()
+	{
+		d2d::Window::SetViewRect();
+		b2Vec2 resolution{ d2d::Window::GetViewSize() };
+		d2d::Window::SetCameraRect({ b2Vec2_zero, resolution });
+
+		d2d::Window::DisableTextures();
+		d2d::Window::EnableBlending();
+		d2d::Window::SetColor(GUISettings::HUD::Text::Color::PROFILER);
+		d2d::Window::PushMatrix();
+		d2d::Window::Translate(GUISettings::HUD::Text::Position::PROFILER * resolution);
+		auto drawLine = [&](const std::string& line)
+		{
+			d2d::Window::DrawString(line, GUISettings::HUD::Text::Size::PROFILER * resolution.y,
+				m_HUDFont, GUISettings::HUD::Text::Position::PROFILER_ALIGNMENT);
+			d2d::Window::Translate({ 0.0f, -GUISettings::HUD::Text::Size::PROFILER_LINE_SPACING * resolution.y });
+		};
+		drawLine("min / avg / p99 (ms)");
+
+		const Profiler& profiler{ m_game.GetProfiler() };
+		std::ostringstream line;
+		line << std::fixed << std::setprecision(2);
+		for(ProfilerPhaseID i = 0; i < profiler.GetNumPhases(); ++i)
+		{
+			Profiler::Stats stats{ profiler.GetStats(i) };
+			if(stats.numSamples == 0)
+				continue;
+			line.str({});
+			line << stats.name << "  " << stats.minMilliseconds << " / " << stats.avgMilliseconds << " / " << stats.p99Milliseconds;
+			drawLine(line.str());
+		}
+		d2d::Window::PopMatrix();
+	}
 
 	void GameState::ProcessEvent(const SDL_Event& event)
 	{
@@ -346,6 +385,7 @@ namespace Space
 	{
 		if(key == m_keyboard.map.pauseKey)					PauseGame();
 		else if(key == m_keyboard.map.fpsToggleKey)			m_showFPS = !m_showFPS;
+		else if(key == m_keyboard.map.profilerToggleKey)	m_showProfiler = !m_showProfiler;
 		else if(key == m_keyboard.map.zoomInKey)			m_keyboard.zoomIn = true;
 		else if(key == m_keyboard.map.zoomOutKey)			m_keyboard.zoomOut = true;
 		else if(key == m_keyboard.map.turnLeftKey)			m_keyboard.turnLeft = true;
@@ -52,6 +52,7 @@ namespace Space
 
 		void UpdatePlayerController();
 		void DrawFPS();
+		void DrawProfiler();
 
 		// Game
 		GameMode m_mode;
@@ -59,6 +60,7 @@ namespace Space
 		Shop m_shop;
 		d2d::Menu m_menu;
 		bool m_showFPS;
+		bool m_showProfiler;
 
 		// Gamepad input configuration
 		Gamepad m_gamepad;
@@ -10,8 +10,123 @@
 #include "pch.h"
 #include "ParticleSystem.h"
 
+#if defined(__AVX__)
+	#define SPACE_PARTICLE_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SPACE_PARTICLE_SIMD_WIDTH 4
+#else
+	#define SPACE_PARTICLE_SIMD_WIDTH 1
+#endif
+#if SPACE_PARTICLE_SIMD_WIDTH > 1
+	#include <immintrin.h>
+#endif
+
 namespace Space
 {
+	//+------------------------\----------------------------------
+	//|		   Kernels		   |
+	//\------------------------/----------------------------------
+	// Each kernel handles [0, count) with vectors and finishes the remainder
+	// with the plain loop, which is also the fallback when SIMD is disabled.
+	namespace
+	{
+#if SPACE_PARTICLE_SIMD_WIDTH == 8
+		using FloatVector = __m256;
+		inline FloatVector Load(const float* p) { return _mm256_loadu_ps(p); }
+		inline void Store(float* p, FloatVector v) { _mm256_storeu_ps(p, v); }
+		inline FloatVector Set(float f) { return _mm256_set1_ps(f); }
+		inline FloatVector Add(FloatVector a, FloatVector b) { return _mm256_add_ps(a, b); }
+		inline FloatVector Sub(FloatVector a, FloatVector b) { return _mm256_sub_ps(a, b); }
+		inline FloatVector Mul(FloatVector a, FloatVector b) { return _mm256_mul_ps(a, b); }
+		inline bool AnyGreaterOrEqual(FloatVector a, FloatVector b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ)) != 0; }
+#elif SPACE_PARTICLE_SIMD_WIDTH == 4
+		using FloatVector = __m128;
+		inline FloatVector Load(const float* p) { return _mm_loadu_ps(p); }
+		inline void Store(float* p, FloatVector v) { _mm_storeu_ps(p, v); }
+		inline FloatVector Set(float f) { return _mm_set1_ps(f); }
+		inline FloatVector Add(FloatVector a, FloatVector b) { return _mm_add_ps(a, b); }
+		inline FloatVector Sub(FloatVector a, FloatVector b) { return _mm_sub_ps(a, b); }
+		inline FloatVector Mul(FloatVector a, FloatVector b) { return _mm_mul_ps(a, b); }
+		inline bool AnyGreaterOrEqual(FloatVector a, FloatVector b) { return _mm_movemask_ps(_mm_cmpge_ps(a, b)) != 0; }
+#endif
+		const ParticleID SIMD_WIDTH{ SPACE_PARTICLE_SIMD_WIDTH };
+
+		// last = position; position += dt * velocity
+		void IntegrateKernel(float* lastPositions, float* positions, const float* velocities,
+			float dt, ParticleID count, bool useSIMD)
+		{
+			ParticleID i = 0;
+#if SPACE_PARTICLE_SIMD_WIDTH > 1
+			if(useSIMD)
+			{
+				FloatVector dtVector{ Set(dt) };
+				for(; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+				{
+					FloatVector position{ Load(positions + i) };
+					Store(lastPositions + i, position);
+					Store(positions + i, Add(position, Mul(dtVector, Load(velocities + i))));
+				}
+			}
+#endif
+			for(; i < count; ++i)
+			{
+				lastPositions[i] = positions[i];
+				positions[i] += dt * velocities[i];
+			}
+		}
+
+		// ages += dt
+		void AgeKernel(float* ages, float dt, ParticleID count, bool useSIMD)
+		{
+			ParticleID i = 0;
+#if SPACE_PARTICLE_SIMD_WIDTH > 1
+			if(useSIMD)
+			{
+				FloatVector dtVector{ Set(dt) };
+				for(; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+					Store(ages + i, Add(Load(ages + i), dtVector));
+			}
+#endif
+			for(; i < count; ++i)
+				ages[i] += dt;
+		}
+
+		// smoothed = last + alpha * (position - last)
+		void LerpKernel(float* smoothedPositions, const float* lastPositions, const float* positions,
+			float alpha, ParticleID count, bool useSIMD)
+		{
+			ParticleID i = 0;
+#if SPACE_PARTICLE_SIMD_WIDTH > 1
+			if(useSIMD)
+			{
+				FloatVector alphaVector{ Set(alpha) };
+				for(; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+				{
+					FloatVector last{ Load(lastPositions + i) };
+					Store(smoothedPositions + i, Add(last, Mul(alphaVector, Sub(Load(positions + i), last))));
+				}
+			}
+#endif
+			for(; i < count; ++i)
+				smoothedPositions[i] = lastPositions[i] + alpha * (positions[i] - lastPositions[i]);
+		}
+
+		// Number of particles from first that are all still alive, in whole vectors
+		ParticleID CountLivingVectors(const float* ages, const float* lifetimes, ParticleID first, ParticleID count)
+		{
+			ParticleID i = first;
+#if SPACE_PARTICLE_SIMD_WIDTH > 1
+			for(; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+				if(AnyGreaterOrEqual(Load(ages + i), Load(lifetimes + i)))
+					break;
+#endif
+			return i - first;
+		}
+	}
+
+	//+------------------------\----------------------------------
+	//|	   ParticleSystem	   |
+	//\------------------------/----------------------------------
 	ParticleSystem::~ParticleSystem()
 	{
 		d2LogDebug << "ParticleSystem required " << m_highestActiveParticleCount << " / " << MAX_PARTICLES << " particles. ";
@@ -20,25 +135,51 @@ namespace Space
 	{
 		firstUnusedIndex = 0;
 	}
+	bool ParticleSystem::AddParticle(const ParticleDef& def)
+	{
+		if(firstUnusedIndex >= MAX_PARTICLES)
+			return false;
+
+		ParticleID i{ firstUnusedIndex++ };
+		ages[i] = 0.0f;
+		lifetimes[i] = def.lifetime;
+		fadeIns[i] = def.fadeIn;
+		fadeOuts[i] = def.fadeOut;
+		positionsX[i] = lastPositionsX[i] = smoothedPositionsX[i] = def.position.x;
+		positionsY[i] = lastPositionsY[i] = smoothedPositionsY[i] = def.position.y;
+		velocitiesX[i] = def.velocity.x;
+		velocitiesY[i] = def.velocity.y;
+		layers[i] = def.layer;
+		colors[i] = def.color;
+		pointSizeIndices[i] = def.pointSizeIndex;
+		return true;
+	}
 	void ParticleSystem::Update(float dt)
 	{
 		// Keep track of how close we get to running out of particles
 		if(firstUnusedIndex > m_highestActiveParticleCount)
 			m_highestActiveParticleCount = firstUnusedIndex;
 
-		// Save positions for interpolation, move particles, and interpolate
-		for(ParticleID i = 0; i < firstUnusedIndex; ++i)
-		{
-			physics[i].lastPosition = physics[i].position;
-			physics[i].position += dt * physics[i].velocity;
-		}
+		// Save positions for interpolation and move particles
+		IntegrateKernel(lastPositionsX, positionsX, velocitiesX, dt, firstUnusedIndex, m_SIMDEnabled);
+		IntegrateKernel(lastPositionsY, positionsY, velocitiesY, dt, firstUnusedIndex, m_SIMDEnabled);
 
 		// Update ages and delete dead particles
+		AgeKernel(ages, dt, firstUnusedIndex, m_SIMDEnabled);
+		CullDeadParticles();
+	}
+	void ParticleSystem::CullDeadParticles()
+	{
 		ParticleID i = 0;
 		while(i < firstUnusedIndex)
 		{
-			timers[i].age += dt;
-			if(timers[i].age >= timers[i].lifetime)
+			// Skip whole vectors of living particles
+			if(m_SIMDEnabled)
+				i += CountLivingVectors(ages, lifetimes, i, firstUnusedIndex);
+			if(i >= firstUnusedIndex)
+				break;
+
+			if(ages[i] >= lifetimes[i])
 				DeleteParticle(i);
 			else
 				++i;
@@ -46,29 +187,55 @@ namespace Space
 	}
 	void ParticleSystem::SmoothStates(float timestepAlpha)
 	{
-		for(ParticleID i = 0; i < firstUnusedIndex; ++i)
-			smoothedPositions[i] = d2d::Lerp(physics[i].lastPosition, physics[i].position, timestepAlpha);
+		LerpKernel(smoothedPositionsX, lastPositionsX, positionsX, timestepAlpha, firstUnusedIndex, m_SIMDEnabled);
+		LerpKernel(smoothedPositionsY, lastPositionsY, positionsY, timestepAlpha, firstUnusedIndex, m_SIMDEnabled);
 	}
 	float ParticleSystem::CalculateFadedAlpha(ParticleID index) const
 	{
 		// Partial alpha during fade-in or fade-out stages
-		if(timers[index].age < timers[index].fadeIn)
+		if(ages[index] < fadeIns[index])
 		{
-			float fadeInPercent{ timers[index].age / timers[index].fadeIn };
+			float fadeInPercent{ ages[index] / fadeIns[index] };
 			return colors[index].alpha * fadeInPercent;
 		}
-		else if(timers[index].age > timers[index].lifetime - timers[index].fadeOut)
+		else if(ages[index] > lifetimes[index] - fadeOuts[index])
 		{
-			float fadeOutPercent{ (timers[index].age - (timers[index].lifetime - timers[index].fadeOut)) / timers[index].fadeOut };
+			float fadeOutPercent{ (ages[index] - (lifetimes[index] - fadeOuts[index])) / fadeOuts[index] };
 			return colors[index].alpha * (1.0f - fadeOutPercent);
 		}
 		else
 			return colors[index].alpha;
 	}
+	b2Vec2 ParticleSystem::GetSmoothedPosition(ParticleID index) const
+	{
+		return { smoothedPositionsX[index], smoothedPositionsY[index] };
+	}
+	ParticleID ParticleSystem::GetParticleCount() const
+	{
+		return firstUnusedIndex;
+	}
+	void ParticleSystem::SetSIMDEnabled(bool enabled)
+	{
+		m_SIMDEnabled = enabled;
+	}
+	unsigned ParticleSystem::GetSIMDWidth()
+	{
+		return SPACE_PARTICLE_SIMD_WIDTH;
+	}
 	void ParticleSystem::CopyParticle(ParticleID from, ParticleID to)
 	{
-		timers[to] = timers[from];
-		physics[to] = physics[from];
+		ages[to] = ages[from];
+		lifetimes[to] = lifetimes[from];
+		fadeIns[to] = fadeIns[from];
+		fadeOuts[to] = fadeOuts[from];
+		positionsX[to] = positionsX[from];
+		positionsY[to] = positionsY[from];
+		lastPositionsX[to] = lastPositionsX[from];
+		lastPositionsY[to] = lastPositionsY[from];
+		velocitiesX[to] = velocitiesX[from];
+		velocitiesY[to] = velocitiesY[from];
+		smoothedPositionsX[to] = smoothedPositionsX[from];
+		smoothedPositionsY[to] = smoothedPositionsY[from];
 		layers[to] = layers[from];
 		colors[to] = colors[from];
 		pointSizeIndices[to] = pointSizeIndices[from];
@@ -80,5 +247,3 @@ namespace Space
 		CopyParticle(firstUnusedIndex, index);
 	}
 }
-
-
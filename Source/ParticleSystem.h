@@ -11,46 +11,64 @@
 namespace Space
 {
 	using ParticleID = unsigned long;
-	struct ParticleTimer
+	struct ParticleDef
 	{
+		b2Vec2 position;
+		b2Vec2 velocity;
 		float lifetime{};
 		float fadeIn{};
 		float fadeOut{};
-		float age{};
-	};
-	struct ParticlePhysics
-	{
-		b2Vec2 lastPosition;
-		b2Vec2 position;
-		b2Vec2 velocity;
+		int layer{};
+		d2d::Color color;
+		unsigned pointSizeIndex{};
 	};
 	enum class ParticleExplosionType
 	{
 		CIRCLE, RECT, USE_BODY_SHAPES
 	};
 	const ParticleID MAX_PARTICLES{ 50000 };
+
+	// Particles are stored as structure-of-arrays so that Update and SmoothStates
+	// can run SIMD kernels over plain float arrays. The kernels use AVX when the
+	// compiler targets it, SSE2 otherwise, and plain loops when neither is available.
 	class ParticleSystem
 	{
 	public:
 		~ParticleSystem();
 		void Init();
+		bool AddParticle(const ParticleDef& def);
 		void Update(float dt);
 		void SmoothStates(float timestepAlpha);
 		float CalculateFadedAlpha(ParticleID index) const;
+		b2Vec2 GetSmoothedPosition(ParticleID index) const;
+		ParticleID GetParticleCount() const;
+
+		// Use the plain loops even if SIMD kernels are compiled in, for comparison
+		void SetSIMDEnabled(bool enabled);
+		static unsigned GetSIMDWidth();
 
 	private:
 		// If you add more components, add it to CopyParticle()
-		ParticleTimer timers[MAX_PARTICLES];
-		ParticlePhysics physics[MAX_PARTICLES];
-		b2Vec2 smoothedPositions[MAX_PARTICLES];
+		alignas(32) float ages[MAX_PARTICLES];
+		alignas(32) float lifetimes[MAX_PARTICLES];
+		alignas(32) float fadeIns[MAX_PARTICLES];
+		alignas(32) float fadeOuts[MAX_PARTICLES];
+		alignas(32) float positionsX[MAX_PARTICLES];
+		alignas(32) float positionsY[MAX_PARTICLES];
+		alignas(32) float lastPositionsX[MAX_PARTICLES];
+		alignas(32) float lastPositionsY[MAX_PARTICLES];
+		alignas(32) float velocitiesX[MAX_PARTICLES];
+		alignas(32) float velocitiesY[MAX_PARTICLES];
+		alignas(32) float smoothedPositionsX[MAX_PARTICLES];
+		alignas(32) float smoothedPositionsY[MAX_PARTICLES];
 		int layers[MAX_PARTICLES];
 		d2d::Color colors[MAX_PARTICLES];
-		float fadedAlphas[MAX_PARTICLES];
 		unsigned pointSizeIndices[MAX_PARTICLES];
 		ParticleID firstUnusedIndex{ 0 };
 
 		ParticleID m_highestActiveParticleCount{ 0u };
-		float m_timestepAccumulator{ 0.0f };
+		bool m_SIMDEnabled{ true };
+		void CullDeadParticles();
 		void CopyParticle(ParticleID from, ParticleID to);
 		void DeleteParticle(ParticleID index);
 
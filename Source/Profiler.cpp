@@ -0,0 +1,64 @@
+/**************************************************************************************\
+** File: Profiler.cpp
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Source code file for the Profiler class
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "Profiler.h"
+namespace Space
+{
+	ProfilerPhaseID Profiler::AddPhase(const char* name)
+	{
+		d2Assert(name);
+		for(ProfilerPhaseID i = 0; i < m_phases.size(); ++i)
+			if(std::string_view{ m_phases[i].name } == name)
+				return i;
+		m_phases.emplace_back();
+		m_phases.back().name = name;
+		return (ProfilerPhaseID)(m_phases.size() - 1);
+	}
+	void Profiler::Record(ProfilerPhaseID phaseID, float seconds)
+	{
+		d2Assert(phaseID < m_phases.size());
+		Phase& phase{ m_phases[phaseID] };
+		phase.samples[phase.next] = seconds;
+		phase.next = (phase.next + 1) % SAMPLE_WINDOW;
+		if(phase.count < SAMPLE_WINDOW)
+			++phase.count;
+	}
+	void Profiler::Clear()
+	{
+		for(Phase& phase : m_phases)
+		{
+			phase.next = 0;
+			phase.count = 0;
+		}
+	}
+	Profiler::Stats Profiler::GetStats(ProfilerPhaseID phaseID) const
+	{
+		d2Assert(phaseID < m_phases.size());
+		const Phase& phase{ m_phases[phaseID] };
+		Stats stats;
+		stats.name = phase.name;
+		stats.numSamples = phase.count;
+		if(phase.count == 0)
+			return stats;
+
+		std::array<float, SAMPLE_WINDOW> sorted;
+		std::copy_n(phase.samples.begin(), phase.count, sorted.begin());
+		double total{ 0.0 };
+		for(size_t i = 0; i < phase.count; ++i)
+			total += sorted[i];
+		size_t p99Index{ (phase.count * 99 + 99) / 100 - 1 };
+		std::nth_element(sorted.begin(), sorted.begin() + p99Index, sorted.begin() + phase.count);
+
+		stats.minMilliseconds = 1000.0 * *std::min_element(sorted.begin(), sorted.begin() + phase.count);
+		stats.avgMilliseconds = 1000.0 * total / phase.count;
+		stats.p99Milliseconds = 1000.0 * sorted[p99Index];
+		return stats;
+	}
+}
@@ -0,0 +1,89 @@
+/**************************************************************************************\
+** File: Profiler.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the Profiler and ScopedTimer classes
+**
+\**************************************************************************************/
+#pragma once
+#include "Trace.h"
+namespace Space
+{
+	using ProfilerPhaseID = unsigned;
+	const ProfilerPhaseID INVALID_PROFILER_PHASE_ID{ std::numeric_limits<ProfilerPhaseID>::max() };
+
+	//+---------------------------------------------\
+	//|  Profiler: rolling timings of named phases  |
+	//\---------------------------------------------/
+	// Each phase keeps its last SAMPLE_WINDOW timings in a fixed ring, so
+	// recording never allocates. Phases are added up front, from one thread;
+	// after that, different threads may record different phases at the same time.
+	// Stats are read between updates, when nothing is recording.
+	class Profiler
+	{
+	public:
+		static constexpr size_t SAMPLE_WINDOW{ 128 };
+		struct Stats
+		{
+			const char* name{};
+			size_t numSamples{};
+			double minMilliseconds{};
+			double avgMilliseconds{};
+			double p99Milliseconds{};
+		};
+
+		// Returns the phase already added under name, if any. name must outlive the profiler.
+		ProfilerPhaseID AddPhase(const char* name);
+		void Record(ProfilerPhaseID phaseID, float seconds);
+		void Clear();
+
+		size_t GetNumPhases() const { return m_phases.size(); }
+		const char* GetPhaseName(ProfilerPhaseID phaseID) const { return m_phases[phaseID].name; }
+		Stats GetStats(ProfilerPhaseID phaseID) const;
+
+	private:
+		struct alignas(64) Phase
+		{
+			const char* name{};
+			std::array<float, SAMPLE_WINDOW> samples{};
+			size_t next{};
+			size_t count{};
+		};
+		std::vector<Phase> m_phases;
+	};
+
+	//+---------------------------------------------\
+	//|  ScopedTimer: records its lifetime          |
+	//\---------------------------------------------/
+	// Does nothing without a profiler or with an invalid phase,
+	// so timed code doesn't have to check. While tracing, also
+	// records a trace event named after the phase.
+	class ScopedTimer
+	{
+	public:
+		ScopedTimer(Profiler* profilerPtr, ProfilerPhaseID phaseID)
+			: m_profilerPtr{ phaseID == INVALID_PROFILER_PHASE_ID ? nullptr : profilerPtr }, m_phaseID{ phaseID }
+		{
+			if(m_profilerPtr)
+				m_startTime = std::chrono::steady_clock::now();
+		}
+		~ScopedTimer()
+		{
+			if(!m_profilerPtr)
+				return;
+			auto endTime{ std::chrono::steady_clock::now() };
+			m_profilerPtr->Record(m_phaseID, std::chrono::duration<float>{ endTime - m_startTime }.count());
+			if(IsTracing())
+				RecordTraceEvent(m_profilerPtr->GetPhaseName(m_phaseID), m_startTime, endTime);
+		}
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+	private:
+		Profiler* m_profilerPtr;
+		ProfilerPhaseID m_phaseID;
+		std::chrono::steady_clock::time_point m_startTime;
+	};
+}
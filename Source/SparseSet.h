@@ -0,0 +1,95 @@
+/**************************************************************************************\
+** File: SparseSet.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the SparseSet class template
+**
+\**************************************************************************************/
+#pragma once
+#include "Components.h"
+namespace Space
+{
+	//+---------------------------------------------\
+	//|  SparseSet: per-component entity storage    |
+	//\---------------------------------------------/
+	// Component data is kept packed in a dense array alongside the IDs of the
+	// entities that own it. A sparse table maps an entity's slot index to its
+	// dense index. Removal swaps the last element into the hole, so dense order
+	// is not stable and references into the set are invalidated by Insert and Erase.
+	template<class T>
+	class SparseSet
+	{
+	public:
+		// Also rejects stale handles whose slot now belongs to a newer entity
+		bool Contains(EntityID entityID) const
+		{
+			EntityID index{ GetEntityIndex(entityID) };
+			return index < m_sparse.size() && m_sparse[index] != INVALID_INDEX &&
+				m_entityIDs[m_sparse[index]] == entityID;
+		}
+
+		// Returns existing data if the entity already owns an element
+		T& Insert(EntityID entityID)
+		{
+			if(Contains(entityID))
+				return m_data[m_sparse[GetEntityIndex(entityID)]];
+
+			EntityID index{ GetEntityIndex(entityID) };
+			if(index >= m_sparse.size())
+				m_sparse.resize(index + 1, INVALID_INDEX);
+			d2Assert(m_sparse[index] == INVALID_INDEX);
+			m_sparse[index] = m_entityIDs.size();
+			m_entityIDs.push_back(entityID);
+			m_data.emplace_back();
+			return m_data.back();
+		}
+		void Erase(EntityID entityID)
+		{
+			if(!Contains(entityID))
+				return;
+
+			size_t index{ m_sparse[GetEntityIndex(entityID)] };
+			size_t lastIndex{ m_entityIDs.size() - 1 };
+			if(index != lastIndex)
+			{
+				m_data[index] = std::move(m_data[lastIndex]);
+				m_entityIDs[index] = m_entityIDs[lastIndex];
+				m_sparse[GetEntityIndex(m_entityIDs[index])] = index;
+			}
+			m_data.pop_back();
+			m_entityIDs.pop_back();
+			m_sparse[GetEntityIndex(entityID)] = INVALID_INDEX;
+		}
+		void Clear()
+		{
+			m_sparse.clear();
+			m_entityIDs.clear();
+			m_data.clear();
+		}
+
+		T& operator[](EntityID entityID)
+		{
+			d2Assert(Contains(entityID));
+			return m_data[m_sparse[GetEntityIndex(entityID)]];
+		}
+		const T& operator[](EntityID entityID) const
+		{
+			d2Assert(Contains(entityID));
+			return m_data[m_sparse[GetEntityIndex(entityID)]];
+		}
+
+		size_t Size() const { return m_entityIDs.size(); }
+		bool Empty() const { return m_entityIDs.empty(); }
+		const std::vector<EntityID>& GetEntityIDs() const { return m_entityIDs; }
+		std::vector<T>& GetData() { return m_data; }
+		const std::vector<T>& GetData() const { return m_data; }
+
+	private:
+		static constexpr size_t INVALID_INDEX{ std::numeric_limits<size_t>::max() };
+		std::vector<size_t> m_sparse;
+		std::vector<EntityID> m_entityIDs;
+		std::vector<T> m_data;
+	};
+}
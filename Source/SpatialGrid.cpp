@@ -0,0 +1,237 @@
+/**************************************************************************************\
+** File: SpatialGrid.cpp
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Source code file for the SpatialGrid class
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "SpatialGrid.h"
+namespace Space
+{
+	void SpatialGrid::Init(const d2d::Rect& worldRect, float cellSize)
+	{
+		d2Assert(cellSize > 0.0f);
+		m_worldRect = worldRect;
+		m_worldDimensions = worldRect.GetDimensions();
+		m_numColumns = std::max(1, (int)std::ceil(m_worldDimensions.x / cellSize));
+		m_numRows = std::max(1, (int)std::ceil(m_worldDimensions.y / cellSize));
+
+		// Stretch cells slightly so they tile the world exactly
+		m_cellDimensions.Set(m_worldDimensions.x / m_numColumns, m_worldDimensions.y / m_numRows);
+
+		// Keep cell capacity from the last level
+		for(std::vector<Entry>& cell : m_cells)
+			cell.clear();
+		m_cells.resize((size_t)m_numColumns * m_numRows);
+		m_locations.clear();
+		m_maxBoundingRadius = 0.0f;
+	}
+	void SpatialGrid::Update(EntityID entityID, const b2Vec2& position, float boundingRadius)
+	{
+		EntityID index{ GetEntityIndex(entityID) };
+		if(index >= m_locations.size())
+			m_locations.resize(index + 1, { INVALID_CELL, 0 });
+		m_maxBoundingRadius = std::max(m_maxBoundingRadius, boundingRadius);
+
+		// Update in place if the entity has not changed cells
+		size_t newCell{ GetCell(position) };
+		if(m_locations[index].cell == newCell)
+		{
+			Entry& entry{ m_cells[newCell][m_locations[index].slot] };
+			entry.entityID = entityID;
+			entry.position = position;
+			entry.boundingRadius = boundingRadius;
+			return;
+		}
+
+		Remove(entityID);
+		m_locations[index].cell = newCell;
+		m_locations[index].slot = m_cells[newCell].size();
+		m_cells[newCell].push_back({ entityID, position, boundingRadius });
+	}
+	void SpatialGrid::Remove(EntityID entityID)
+	{
+		EntityID index{ GetEntityIndex(entityID) };
+		if(index >= m_locations.size() || m_locations[index].cell == INVALID_CELL)
+			return;
+
+		// Swap the last entry of the cell into the hole
+		std::vector<Entry>& cell{ m_cells[m_locations[index].cell] };
+		size_t slot{ m_locations[index].slot };
+		if(slot != cell.size() - 1)
+		{
+			cell[slot] = cell.back();
+			m_locations[GetEntityIndex(cell[slot].entityID)].slot = slot;
+		}
+		cell.pop_back();
+		m_locations[index].cell = INVALID_CELL;
+	}
+	void SpatialGrid::QueryRadius(const b2Vec2& position, float radius, std::vector<EntityID>& entityIDsOut) const
+	{
+		// Cells that could hold an entity touching the circle. Counted before wrapping,
+		// so a span longer than the world covers each column or row once.
+		float reach{ radius + m_maxBoundingRadius };
+		int firstColumn, firstRow, lastColumn, lastRow;
+		GetUnwrappedColumnRow(position - b2Vec2{ reach, reach }, firstColumn, firstRow);
+		GetUnwrappedColumnRow(position + b2Vec2{ reach, reach }, lastColumn, lastRow);
+		int numColumns{ std::min(lastColumn - firstColumn + 1, m_numColumns) };
+		int numRows{ std::min(lastRow - firstRow + 1, m_numRows) };
+
+		for(int row = 0; row < numRows; ++row)
+			for(int column = 0; column < numColumns; ++column)
+				for(const Entry& entry : m_cells[GetCell(firstColumn + column, firstRow + row)])
+					if(GetGap(position, radius, entry) <= 0.0f)
+						entityIDsOut.push_back(entry.entityID);
+	}
+	void SpatialGrid::QueryRadii(const std::vector<AreaQuery>& queries, AreaQueryResults& resultsOut,
+		WorkerPool* workerPoolPtr) const
+	{
+		resultsOut.m_entityIDs.clear();
+		resultsOut.m_offsets.clear();
+		resultsOut.m_offsets.push_back(0);
+
+		// Not worth handing out a handful of queries
+		const size_t MIN_QUERIES_PER_BATCH{ 64 };
+		size_t maxBatches{ workerPoolPtr ? workerPoolPtr->GetNumWorkers() + 1 : 1 };
+		size_t numBatches{ std::clamp<size_t>(queries.size() / MIN_QUERIES_PER_BATCH, 1, maxBatches) };
+		if(numBatches == 1)
+		{
+			for(const AreaQuery& query : queries)
+			{
+				QueryRadius(query.position, query.radius, resultsOut.m_entityIDs);
+				resultsOut.m_offsets.push_back(resultsOut.m_entityIDs.size());
+			}
+			return;
+		}
+
+		// Each batch is a contiguous range of queries answered into its own scratch.
+		// Submit all but the first, answer the first here, then help until all are done.
+		resultsOut.m_batchEntityIDs.resize(numBatches);
+		resultsOut.m_batchOffsets.resize(numBatches);
+		QueryBatches batches{ this, &queries, &resultsOut, (queries.size() + numBatches - 1) / numBatches, numBatches };
+		for(size_t batch = 1; batch < numBatches; ++batch)
+			workerPoolPtr->Submit({ &SpatialGrid::QueryBatchTask, &batches, batch });
+		QueryBatchTask(&batches, 0);
+		while(batches.numBatchesLeft.load(std::memory_order_acquire) > 0)
+			if(!workerPoolPtr->RunPendingTask())
+				std::this_thread::yield();
+
+		// Merge in query order
+		for(size_t batch = 0; batch < numBatches; ++batch)
+		{
+			size_t base{ resultsOut.m_entityIDs.size() };
+			const std::vector<EntityID>& entityIDs{ resultsOut.m_batchEntityIDs[batch] };
+			resultsOut.m_entityIDs.insert(resultsOut.m_entityIDs.end(), entityIDs.begin(), entityIDs.end());
+			for(size_t offset : resultsOut.m_batchOffsets[batch])
+				resultsOut.m_offsets.push_back(base + offset);
+		}
+	}
+	void SpatialGrid::QueryClosest(const b2Vec2& position, float radius, unsigned count,
+		std::vector<std::pair<EntityID, float>>& closestOut) const
+	{
+		closestOut.clear();
+		if(count < 1)
+			return;
+
+		// Search rings of cells around the center cell. Offsets are limited so that
+		// each cell is visited once even when the rings wrap around the world.
+		int centerColumn, centerRow;
+		GetColumnRow(position, centerColumn, centerRow);
+		int minColumnOffset{ -(m_numColumns / 2) };
+		int maxColumnOffset{ (m_numColumns - 1) / 2 };
+		int minRowOffset{ -(m_numRows / 2) };
+		int maxRowOffset{ (m_numRows - 1) / 2 };
+		int maxRing{ std::max({ -minColumnOffset, maxColumnOffset, -minRowOffset, maxRowOffset }) };
+		float minCellDimension{ std::min(m_cellDimensions.x, m_cellDimensions.y) };
+		for(int ring = 0; ring <= maxRing; ++ring)
+		{
+			for(int rowOffset = std::max(-ring, minRowOffset); rowOffset <= std::min(ring, maxRowOffset); ++rowOffset)
+				for(int columnOffset = std::max(-ring, minColumnOffset); columnOffset <= std::min(ring, maxColumnOffset); ++columnOffset)
+				{
+					if(std::max(std::abs(columnOffset), std::abs(rowOffset)) != ring)
+						continue;
+					for(const Entry& entry : m_cells[GetCell(centerColumn + columnOffset, centerRow + rowOffset)])
+					{
+						// Keep the list sorted and no longer than count
+						float gap{ GetGap(position, radius, entry) };
+						if(closestOut.size() == count && gap >= closestOut.back().second)
+							continue;
+						auto it = std::upper_bound(closestOut.begin(), closestOut.end(), gap,
+							[](float gap, const std::pair<EntityID, float>& closest) { return gap < closest.second; });
+						closestOut.insert(it, { entry.entityID, gap });
+						if(closestOut.size() > count)
+							closestOut.pop_back();
+					}
+				}
+
+			// Stop when no entity in the remaining rings can be closer
+			if(closestOut.size() == count)
+			{
+				float minRemainingGap{ ring * minCellDimension - radius - m_maxBoundingRadius };
+				if(minRemainingGap >= closestOut.back().second)
+					break;
+			}
+		}
+	}
+	size_t SpatialGrid::GetCell(const b2Vec2& position) const
+	{
+		int column, row;
+		GetColumnRow(position, column, row);
+		return GetCell(column, row);
+	}
+	size_t SpatialGrid::GetCell(int column, int row) const
+	{
+		column %= m_numColumns;
+		if(column < 0)
+			column += m_numColumns;
+		row %= m_numRows;
+		if(row < 0)
+			row += m_numRows;
+		return (size_t)row * m_numColumns + column;
+	}
+	void SpatialGrid::GetColumnRow(const b2Vec2& position, int& columnOut, int& rowOut) const
+	{
+		GetUnwrappedColumnRow(position, columnOut, rowOut);
+		columnOut %= m_numColumns;
+		if(columnOut < 0)
+			columnOut += m_numColumns;
+		rowOut %= m_numRows;
+		if(rowOut < 0)
+			rowOut += m_numRows;
+	}
+	// Column and row as if the grid repeated past the world edges
+	void SpatialGrid::GetUnwrappedColumnRow(const b2Vec2& position, int& columnOut, int& rowOut) const
+	{
+		b2Vec2 relativePosition{ position - m_worldRect.lowerBound };
+		columnOut = (int)std::floor(relativePosition.x / m_cellDimensions.x);
+		rowOut = (int)std::floor(relativePosition.y / m_cellDimensions.y);
+	}
+	// Gap between bounding circles, measured the short way around the world
+	float SpatialGrid::GetGap(const b2Vec2& position, float radius, const Entry& entry) const
+	{
+		b2Vec2 relativePosition{ entry.position - position };
+		relativePosition.x -= m_worldDimensions.x * std::round(relativePosition.x / m_worldDimensions.x);
+		relativePosition.y -= m_worldDimensions.y * std::round(relativePosition.y / m_worldDimensions.y);
+		return relativePosition.Length() - radius - entry.boundingRadius;
+	}
+	// Answers one batch of a QueryRadii call, then counts it done
+	void SpatialGrid::QueryBatchTask(void* batchesPtr, size_t batchIndex)
+	{
+		QueryBatches& batches{ *static_cast<QueryBatches*>(batchesPtr) };
+		const std::vector<AreaQuery>& queries{ *batches.queriesPtr };
+		std::vector<EntityID>& entityIDs{ batches.resultsPtr->m_batchEntityIDs[batchIndex] };
+		std::vector<size_t>& offsets{ batches.resultsPtr->m_batchOffsets[batchIndex] };
+		entityIDs.clear();
+		offsets.clear();
+		size_t end{ std::min(queries.size(), (batchIndex + 1) * batches.queriesPerBatch) };
+		for(size_t i = batchIndex * batches.queriesPerBatch; i < end; ++i)
+		{
+			batches.gridPtr->QueryRadius(queries[i].position, queries[i].radius, entityIDs);
+			offsets.push_back(entityIDs.size());
+		}
+		batches.numBatchesLeft.fetch_sub(1, std::memory_order_release);
+	}
+}
@@ -0,0 +1,110 @@
+/**************************************************************************************\
+** File: SpatialGrid.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the SpatialGrid class
+**
+\**************************************************************************************/
+#pragma once
+#include "Components.h"
+#include "WorkerPool.h"
+namespace Space
+{
+	// One query of a batch answered by SpatialGrid::QueryRadii
+	struct AreaQuery
+	{
+		b2Vec2 position;
+		float radius;
+	};
+
+	// Reusable output of SpatialGrid::QueryRadii. Results of all queries share
+	// one buffer that keeps its capacity between batches.
+	class AreaQueryResults
+	{
+	public:
+		size_t GetNumQueries() const { return m_offsets.empty() ? 0 : m_offsets.size() - 1; }
+		std::span<const EntityID> operator[](size_t queryIndex) const
+		{
+			d2Assert(queryIndex < GetNumQueries());
+			return { m_entityIDs.data() + m_offsets[queryIndex], m_offsets[queryIndex + 1] - m_offsets[queryIndex] };
+		}
+
+	private:
+		std::vector<EntityID> m_entityIDs;
+		std::vector<size_t> m_offsets;
+
+		// Per-batch scratch, merged into the arrays above
+		std::vector<std::vector<EntityID>> m_batchEntityIDs;
+		std::vector<std::vector<size_t>> m_batchOffsets;
+
+		friend class SpatialGrid;
+	};
+
+	//+---------------------------------------------\
+	//|  SpatialGrid: wrap-aware entity index       |
+	//\---------------------------------------------/
+	// Uniform grid over the world rect holding each entity's position and
+	// bounding radius. Cells and distances wrap around the world edges, so
+	// an entity near one edge is close to entities near the opposite edge.
+	// Entities are moved between cells in O(1) as their positions change.
+	class SpatialGrid
+	{
+	public:
+		void Init(const d2d::Rect& worldRect, float cellSize);
+		void Update(EntityID entityID, const b2Vec2& position, float boundingRadius);
+		void Remove(EntityID entityID);
+
+		// Appends the IDs of entities whose bounding circle intersects the given circle
+		void QueryRadius(const b2Vec2& position, float radius, std::vector<EntityID>& entityIDsOut) const;
+
+		// Answers every query in one call. Large batches are split across the
+		// worker pool, if one is given; the calling thread answers one part itself.
+		void QueryRadii(const std::vector<AreaQuery>& queries, AreaQueryResults& resultsOut,
+			WorkerPool* workerPoolPtr = nullptr) const;
+
+		// Fills closestOut with <id, boundingRadiiGap> of the count closest entities, closest first
+		void QueryClosest(const b2Vec2& position, float radius, unsigned count,
+			std::vector<std::pair<EntityID, float>>& closestOut) const;
+
+	private:
+		struct Entry
+		{
+			EntityID entityID;
+			b2Vec2 position;
+			float boundingRadius;
+		};
+		struct Location
+		{
+			size_t cell;
+			size_t slot;
+		};
+		size_t GetCell(const b2Vec2& position) const;
+		size_t GetCell(int column, int row) const;
+		void GetColumnRow(const b2Vec2& position, int& columnOut, int& rowOut) const;
+		void GetUnwrappedColumnRow(const b2Vec2& position, int& columnOut, int& rowOut) const;
+		float GetGap(const b2Vec2& position, float radius, const Entry& entry) const;
+
+		// Shared by the tasks of one QueryRadii call
+		struct QueryBatches
+		{
+			const SpatialGrid* gridPtr;
+			const std::vector<AreaQuery>* queriesPtr;
+			AreaQueryResults* resultsPtr;
+			size_t queriesPerBatch;
+			std::atomic<size_t> numBatchesLeft;
+		};
+		static void QueryBatchTask(void* batchesPtr, size_t batchIndex);
+
+		static constexpr size_t INVALID_CELL{ std::numeric_limits<size_t>::max() };
+		d2d::Rect m_worldRect;
+		b2Vec2 m_worldDimensions;
+		b2Vec2 m_cellDimensions;
+		int m_numColumns{ 1 };
+		int m_numRows{ 1 };
+		float m_maxBoundingRadius{ 0.0f };
+		std::vector<std::vector<Entry>> m_cells;
+		std::vector<Location> m_locations;
+	};
+}
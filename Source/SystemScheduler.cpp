@@ -0,0 +1,110 @@
+/**************************************************************************************\
+** File: SystemScheduler.cpp
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Source code file for the SystemScheduler class
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "SystemScheduler.h"
+namespace Space
+{
+	void SystemScheduler::Clear()
+	{
+		m_systems.clear();
+		m_dependenciesLeft.reset();
+	}
+	void SystemScheduler::SetNumWorkerThreads(unsigned numWorkerThreads)
+	{
+		if(numWorkerThreads != m_workerPool.GetNumWorkers())
+			m_workerPool.Start(numWorkerThreads);
+	}
+	void SystemScheduler::SetProfiler(Profiler* profilerPtr)
+	{
+		m_profilerPtr = profilerPtr;
+		for(System& system : m_systems)
+			system.profilerPhaseID = m_profilerPtr ? m_profilerPtr->AddPhase(system.name) : INVALID_PROFILER_PHASE_ID;
+	}
+	void SystemScheduler::AddSystem(const char* name, const ResourceBitset& reads, const ResourceBitset& writes,
+		std::function<void()> system)
+	{
+		d2Assert(system);
+		System newSystem{ name, reads, writes, std::move(system) };
+		if(m_profilerPtr)
+			newSystem.profilerPhaseID = m_profilerPtr->AddPhase(name);
+
+		// Depend on every earlier system that conflicts
+		size_t newIndex{ m_systems.size() };
+		for(size_t i = 0; i < newIndex; ++i)
+		{
+			const System& earlier{ m_systems[i] };
+			if((earlier.writes & (newSystem.reads | newSystem.writes)).any() || (earlier.reads & newSystem.writes).any())
+			{
+				m_systems[i].dependents.push_back(newIndex);
+				++newSystem.numDependencies;
+			}
+		}
+		m_systems.push_back(std::move(newSystem));
+		m_dependenciesLeft = std::make_unique<std::atomic<unsigned>[]>(m_systems.size());
+	}
+	void SystemScheduler::Run()
+	{
+		if(m_workerPool.GetNumWorkers() == 0)
+		{
+			for(System& system : m_systems)
+				RunSystem(system);
+			return;
+		}
+
+		m_exceptionPtr = nullptr;
+		m_failed = false;
+		m_numSystemsLeft = m_systems.size();
+		for(size_t i = 0; i < m_systems.size(); ++i)
+			m_dependenciesLeft[i] = m_systems[i].numDependencies;
+		for(size_t i = 0; i < m_systems.size(); ++i)
+			if(m_systems[i].numDependencies == 0)
+				m_workerPool.Submit({ &SystemScheduler::RunSystemTask, this, i });
+
+		// Help out until done
+		while(m_numSystemsLeft.load(std::memory_order_acquire) > 0)
+			if(!m_workerPool.RunPendingTask())
+				std::this_thread::yield();
+
+		if(m_exceptionPtr)
+			std::rethrow_exception(m_exceptionPtr);
+	}
+	//+---------------------\-------------------------------------------------
+	//|   RunSystemTask		| (private)
+	//\---------------------/-------------------------------------------------
+	// Runs one system, then submits the dependents it was the last to wait for.
+	// Once a system has thrown, the rest are skipped but still counted down so Run can return.
+	void SystemScheduler::RunSystemTask(void* schedulerPtr, size_t systemIndex)
+	{
+		SystemScheduler& scheduler{ *static_cast<SystemScheduler*>(schedulerPtr) };
+		System& system{ scheduler.m_systems[systemIndex] };
+		if(!scheduler.m_failed.load(std::memory_order_acquire))
+		{
+			try {
+				scheduler.RunSystem(system);
+			}
+			catch(...) {
+				std::lock_guard<std::mutex> lock{ scheduler.m_exceptionMutex };
+				if(!scheduler.m_exceptionPtr)
+					scheduler.m_exceptionPtr = std::current_exception();
+				scheduler.m_failed.store(true, std::memory_order_release);
+			}
+		}
+
+		for(size_t dependent : system.dependents)
+			if(scheduler.m_dependenciesLeft[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				scheduler.m_workerPool.Submit({ &SystemScheduler::RunSystemTask, &scheduler, dependent });
+		scheduler.m_numSystemsLeft.fetch_sub(1, std::memory_order_release);
+	}
+	void SystemScheduler::RunSystem(System& system)
+	{
+		ScopedTimer timer{ m_profilerPtr, system.profilerPhaseID };
+		system.function();
+	}
+}
@@ -0,0 +1,81 @@
+/**************************************************************************************\
+** File: SystemScheduler.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the SystemScheduler class
+**
+\**************************************************************************************/
+#pragma once
+#include "Components.h"
+#include "WorkerPool.h"
+#include "Profiler.h"
+namespace Space
+{
+	// Data a system can touch. Component bits stand for their component storage.
+	enum SystemResource : size_t
+	{
+		RESOURCE_ENTITIES = COMPONENT_NUM_BITS,	// entity list, component bits and flags
+		RESOURCE_DESTROY_BUFFER,
+		RESOURCE_B2WORLD,
+		RESOURCE_BODY_WRITES,	// buffered forces and impulses
+		RESOURCE_PARTICLES,
+		RESOURCE_TIMERS,
+		RESOURCE_STATS,	// counters kept for logs and benchmarks
+		RESOURCE_NUM_BITS
+	};
+	typedef std::bitset<RESOURCE_NUM_BITS> ResourceBitset;
+
+	//+---------------------------------------------\
+	//|  SystemScheduler: runs systems in parallel  |
+	//\---------------------------------------------/
+	// Systems are added once, in the order they would run one after another,
+	// along with the resources they read and write. A system waits for every
+	// earlier system it conflicts with: one writes what the other reads or writes.
+	// Systems that don't conflict run at the same time on the worker pool.
+	// Because conflicting systems keep their order, the results are the same
+	// as running everything in order, which is what happens with 0 worker threads.
+	class SystemScheduler
+	{
+	public:
+		void Clear();
+		void SetNumWorkerThreads(unsigned numWorkerThreads);
+
+		// Times every system under its name. Pass nullptr to stop.
+		void SetProfiler(Profiler* profilerPtr);
+		void AddSystem(const char* name, const ResourceBitset& reads, const ResourceBitset& writes,
+			std::function<void()> system);
+
+		// Returns after every system has finished. Rethrows the first exception thrown by a system.
+		void Run();
+
+		// For systems that split their own work into tasks
+		WorkerPool& GetWorkerPool() { return m_workerPool; }
+
+	private:
+		struct System
+		{
+			const char* name;
+			ResourceBitset reads;
+			ResourceBitset writes;
+			std::function<void()> function;
+			ProfilerPhaseID profilerPhaseID{ INVALID_PROFILER_PHASE_ID };
+			unsigned numDependencies{ 0 };
+			std::vector<size_t> dependents;
+		};
+		static void RunSystemTask(void* schedulerPtr, size_t systemIndex);
+		void RunSystem(System& system);
+
+		std::vector<System> m_systems;
+		WorkerPool m_workerPool;
+		Profiler* m_profilerPtr{ nullptr };
+
+		// Per-run state
+		std::unique_ptr<std::atomic<unsigned>[]> m_dependenciesLeft;
+		std::atomic<size_t> m_numSystemsLeft{ 0 };
+		std::mutex m_exceptionMutex;
+		std::exception_ptr m_exceptionPtr;
+		std::atomic<bool> m_failed{ false };
+	};
+}
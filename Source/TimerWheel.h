@@ -0,0 +1,251 @@
+/**************************************************************************************\
+** File: TimerWheel.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the TimerWheel class template
+**
+\**************************************************************************************/
+#pragma once
+namespace Space
+{
+	// A TimerID is a handle like EntityID: the low half holds the timer's slot,
+	// the high half holds the slot's generation, so handles of fired or cancelled
+	// timers no longer match. Generations start at 1, so 0 is never a valid handle.
+	using TimerID = uint64_t;
+	const TimerID INVALID_TIMER_ID{ 0 };
+
+	//+---------------------------------------------\
+	//|  TimerWheel: hierarchical countdown timers  |
+	//\---------------------------------------------/
+	// Time is counted in ticks, advanced by the owner one at a time. Each level
+	// has 64 buckets; a timer sits in the level whose span covers its expiry
+	// and moves down a level when the level below wraps around, so a pending
+	// timer costs nothing per tick until its bucket comes up. Scheduling,
+	// cancelling, pausing and resuming are O(1). Timers live in one array
+	// reused through a free list.
+	template<class T>
+	class TimerWheel
+	{
+	public:
+		// Fires on the delayTicks-th Advance from now. A delay of 0 is treated as 1.
+		TimerID Schedule(uint64_t delayTicks, const T& payload)
+		{
+			uint32_t index;
+			if(m_freeIndices.empty())
+			{
+				index = (uint32_t)m_timers.size();
+				m_timers.emplace_back();
+			}
+			else
+			{
+				index = m_freeIndices.back();
+				m_freeIndices.pop_back();
+			}
+			Timer& timer{ m_timers[index] };
+			timer.expiry = m_tick + std::max<uint64_t>(delayTicks, 1);
+			timer.payload = payload;
+			timer.pending = true;
+			Link(index);
+			++m_numPending;
+			return MakeTimerID(index, timer.generation);
+		}
+
+		// Returns false if the timer already fired or was cancelled
+		bool Cancel(TimerID timerID)
+		{
+			if(!IsPending(timerID))
+				return false;
+			uint32_t index{ (uint32_t)(timerID & INDEX_MASK) };
+			Unlink(index);
+			Release(index);
+			return true;
+		}
+
+		// Takes the timer out of the wheel, keeping its handle and the ticks it has left.
+		// Returns false if the timer isn't pending or is already paused.
+		bool Pause(TimerID timerID)
+		{
+			if(!IsPending(timerID) || IsPaused(timerID))
+				return false;
+			uint32_t index{ (uint32_t)(timerID & INDEX_MASK) };
+			Timer& timer{ m_timers[index] };
+			Unlink(index);
+			timer.expiry = std::max<uint64_t>(timer.expiry - m_tick, 1);
+			timer.bucket = PAUSED;
+			return true;
+		}
+
+		// Puts a paused timer back, due after the ticks it had left when paused.
+		// Returns false if the timer isn't paused.
+		bool Resume(TimerID timerID)
+		{
+			if(!IsPaused(timerID))
+				return false;
+			uint32_t index{ (uint32_t)(timerID & INDEX_MASK) };
+			Timer& timer{ m_timers[index] };
+			timer.expiry += m_tick;
+			Link(index);
+			return true;
+		}
+
+		// Paused timers are still pending
+		bool IsPending(TimerID timerID) const
+		{
+			uint32_t index{ (uint32_t)(timerID & INDEX_MASK) };
+			return timerID != INVALID_TIMER_ID && index < m_timers.size() &&
+				m_timers[index].pending && m_timers[index].generation == (uint32_t)(timerID >> INDEX_BITS);
+		}
+		bool IsPaused(TimerID timerID) const
+		{
+			return IsPending(timerID) && m_timers[(uint32_t)(timerID & INDEX_MASK)].bucket == PAUSED;
+		}
+
+		// Moves time forward one tick and calls onExpired(timerID, payload) for each
+		// timer that is due. Callbacks may schedule, cancel, pause and resume timers.
+		template<class F>
+		void Advance(F&& onExpired)
+		{
+			++m_tick;
+
+			// Bring timers down from higher levels when the level below wraps around
+			for(unsigned level = 1; level < NUM_LEVELS; ++level)
+			{
+				if(GetBucketIndex(m_tick, level - 1) != 0)
+					break;
+				uint32_t index{ DetachBucket(level, GetBucketIndex(m_tick, level)) };
+				while(index != NONE)
+				{
+					uint32_t next{ m_timers[index].next };
+					Link(index);
+					index = next;
+				}
+			}
+
+			// Everything left in the current bottom bucket expires now. Handles are
+			// taken first so callbacks can cancel or pause timers that haven't fired yet.
+			m_expiring.clear();
+			for(uint32_t index{ DetachBucket(0, GetBucketIndex(m_tick, 0)) }; index != NONE; index = m_timers[index].next)
+			{
+				m_timers[index].bucket = EXPIRING;
+				m_expiring.push_back(MakeTimerID(index, m_timers[index].generation));
+			}
+			for(TimerID timerID : m_expiring)
+			{
+				uint32_t index{ (uint32_t)(timerID & INDEX_MASK) };
+				if(!IsPending(timerID) || m_timers[index].bucket != EXPIRING)
+					continue;
+				T payload{ m_timers[index].payload };
+				Release(index);
+				onExpired(timerID, payload);
+			}
+		}
+		// Handles of timers pending before Clear stay invalid
+		void Clear()
+		{
+			for(uint32_t index = 0; index < m_timers.size(); ++index)
+				if(m_timers[index].pending)
+					Release(index);
+			m_buckets.fill(NONE);
+			m_tick = 0;
+			m_numPending = 0;
+		}
+		uint64_t GetTick() const { return m_tick; }
+		size_t GetNumPending() const { return m_numPending; }
+
+	private:
+		static constexpr unsigned BUCKET_BITS{ 6 };
+		static constexpr uint64_t NUM_BUCKETS{ uint64_t{ 1 } << BUCKET_BITS };
+		static constexpr unsigned NUM_LEVELS{ 4 };
+		static constexpr unsigned INDEX_BITS{ 32 };
+		static constexpr TimerID INDEX_MASK{ (TimerID{ 1 } << INDEX_BITS) - 1 };
+		static constexpr uint32_t NONE{ std::numeric_limits<uint32_t>::max() };
+		static constexpr uint32_t EXPIRING{ NONE - 1 };
+		static constexpr uint32_t PAUSED{ NONE - 2 };
+		struct Timer
+		{
+			uint64_t expiry{};		// ticks left instead while paused
+			T payload{};
+			uint32_t generation{ 1 };
+			uint32_t bucket{ NONE };
+			uint32_t prev{ NONE };
+			uint32_t next{ NONE };
+			bool pending{ false };
+		};
+		static TimerID MakeTimerID(uint32_t index, uint32_t generation)
+		{
+			return (TimerID{ generation } << INDEX_BITS) | index;
+		}
+		static uint32_t GetBucketIndex(uint64_t tick, unsigned level)
+		{
+			return (uint32_t)((tick >> (level * BUCKET_BITS)) & (NUM_BUCKETS - 1));
+		}
+
+		// Puts the timer in the lowest level whose span reaches its expiry.
+		// Expiries past the top level wait in its last bucket and are placed again from there.
+		void Link(uint32_t index)
+		{
+			Timer& timer{ m_timers[index] };
+			uint64_t ticksLeft{ timer.expiry - m_tick };
+			unsigned level{ 0 };
+			while(level < NUM_LEVELS - 1 && ticksLeft >= (NUM_BUCKETS << (level * BUCKET_BITS)))
+				++level;
+			uint64_t bucketTick{ timer.expiry };
+			if(ticksLeft >= (NUM_BUCKETS << (level * BUCKET_BITS)))
+				bucketTick = m_tick + ((NUM_BUCKETS - 1) << (level * BUCKET_BITS));
+			uint32_t bucket{ level * (uint32_t)NUM_BUCKETS + GetBucketIndex(bucketTick, level) };
+
+			timer.bucket = bucket;
+			timer.prev = NONE;
+			timer.next = m_buckets[bucket];
+			if(timer.next != NONE)
+				m_timers[timer.next].prev = index;
+			m_buckets[bucket] = index;
+		}
+		void Unlink(uint32_t index)
+		{
+			Timer& timer{ m_timers[index] };
+			if(timer.bucket == EXPIRING || timer.bucket == PAUSED)
+				return;
+			if(timer.prev != NONE)
+				m_timers[timer.prev].next = timer.next;
+			else
+				m_buckets[timer.bucket] = timer.next;
+			if(timer.next != NONE)
+				m_timers[timer.next].prev = timer.prev;
+		}
+		uint32_t DetachBucket(unsigned level, uint32_t bucketIndex)
+		{
+			uint32_t& head{ m_buckets[level * NUM_BUCKETS + bucketIndex] };
+			uint32_t index{ head };
+			head = NONE;
+			return index;
+		}
+		void Release(uint32_t index)
+		{
+			Timer& timer{ m_timers[index] };
+			timer.pending = false;
+			timer.bucket = NONE;
+			++timer.generation;
+			if(timer.generation == 0)
+				timer.generation = 1;
+			m_freeIndices.push_back(index);
+			--m_numPending;
+		}
+
+		std::vector<Timer> m_timers;
+		std::vector<uint32_t> m_freeIndices;
+		std::array<uint32_t, NUM_LEVELS * NUM_BUCKETS> m_buckets{ MakeEmptyBuckets() };
+		std::vector<TimerID> m_expiring;
+		uint64_t m_tick{ 0 };
+		size_t m_numPending{ 0 };
+
+		static std::array<uint32_t, NUM_LEVELS * NUM_BUCKETS> MakeEmptyBuckets()
+		{
+			std::array<uint32_t, NUM_LEVELS * NUM_BUCKETS> buckets;
+			buckets.fill(NONE);
+			return buckets;
+		}
+	};
+}
@@ -0,0 +1,132 @@
+/**************************************************************************************\
+** File: Trace.cpp
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Source code file for the trace event recorder
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "Trace.h"
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+	struct TraceEvent
+	{
+		const char* name;
+		const char* argName;
+		int arg;
+		uint32_t threadIndex;
+		int64_t beginNanoseconds;
+		int64_t durationNanoseconds;
+	};
+	std::atomic<bool> g_tracing{ false };
+	std::vector<TraceEvent> g_traceEvents;
+	std::atomic<uint64_t> g_traceEventCount{ 0 };
+	std::chrono::steady_clock::time_point g_traceStartTime;
+
+	// Small thread numbers read better in the viewer than std::thread::id
+	std::atomic<uint32_t> g_nextThreadIndex{ 0 };
+	thread_local const uint32_t t_threadIndex{ g_nextThreadIndex.fetch_add(1, std::memory_order_relaxed) };
+
+	//+-----------------------------\-----------------------------
+	//|	   WriteEscapedString       |
+	//\-----------------------------/-----------------------------
+	void WriteEscapedString(std::ostream& out, const char* string)
+	{
+		out << '"';
+		for(const char* c = string; *c; ++c)
+		{
+			if(*c == '"' || *c == '\\')
+				out << '\\';
+			out << *c;
+		}
+		out << '"';
+	}
+}
+namespace Space
+{
+	void StartTracing(size_t eventCapacity)
+	{
+		d2Assert(eventCapacity > 0);
+		g_tracing.store(false, std::memory_order_relaxed);
+		g_traceEvents.assign(eventCapacity, TraceEvent{});
+		g_traceEventCount.store(0, std::memory_order_relaxed);
+		g_traceStartTime = std::chrono::steady_clock::now();
+		g_tracing.store(true, std::memory_order_release);
+	}
+	void StopTracing()
+	{
+		g_tracing.store(false, std::memory_order_relaxed);
+	}
+	bool IsTracing()
+	{
+		return g_tracing.load(std::memory_order_relaxed);
+	}
+	void RecordTraceEvent(const char* name, std::chrono::steady_clock::time_point begin,
+		std::chrono::steady_clock::time_point end, const char* argName, int arg)
+	{
+		d2Assert(name);
+		if(!IsTracing())
+			return;
+
+		begin = std::max(begin, g_traceStartTime);
+		uint64_t slot{ g_traceEventCount.fetch_add(1, std::memory_order_relaxed) };
+		TraceEvent& event{ g_traceEvents[slot % g_traceEvents.size()] };
+		event.name = name;
+		event.argName = argName;
+		event.arg = arg;
+		event.threadIndex = t_threadIndex;
+		event.beginNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - g_traceStartTime).count();
+		event.durationNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+	}
+	bool WriteTrace(const std::string& filePath)
+	{
+		uint64_t eventCount{ g_traceEventCount.load(std::memory_order_acquire) };
+		size_t capacity{ g_traceEvents.size() };
+		size_t numEvents{ (size_t)std::min<uint64_t>(eventCount, capacity) };
+		size_t firstSlot{ eventCount > capacity ? (size_t)(eventCount % capacity) : 0 };
+
+		std::ofstream file{ filePath, std::ios::trunc };
+		if(!file)
+		{
+			d2LogError << "Could not open trace file " << filePath;
+			return false;
+		}
+
+		// Trace event timestamps and durations are in microseconds
+		file << std::fixed << std::setprecision(3);
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		for(size_t i = 0; i < numEvents; ++i)
+		{
+			const TraceEvent& event{ g_traceEvents[(firstSlot + i) % capacity] };
+			file << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+			WriteEscapedString(file, event.name);
+			file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadIndex
+				<< ",\"ts\":" << event.beginNanoseconds / 1000.0
+				<< ",\"dur\":" << event.durationNanoseconds / 1000.0;
+			if(event.argName)
+			{
+				file << ",\"args\":{";
+				WriteEscapedString(file, event.argName);
+				file << ':' << event.arg << '}';
+			}
+			file << '}';
+		}
+		file << "\n]}\n";
+		file.close();
+		if(!file)
+		{
+			d2LogError << "Could not write trace file " << filePath;
+			return false;
+		}
+
+		d2LogInfo << "Wrote " << numEvents << " trace events to " << filePath;
+		if(eventCount > capacity)
+			d2LogInfo << (eventCount - capacity) << " older trace events were overwritten";
+		return true;
+	}
+}
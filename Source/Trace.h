@@ -0,0 +1,59 @@
+/**************************************************************************************\
+** File: Trace.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the trace event recorder
+**
+\**************************************************************************************/
+#pragma once
+namespace Space
+{
+	// Records begin/end pairs as Chrome trace events, viewable in chrome://tracing
+	// or ui.perfetto.dev. Events go into a ring allocated by StartTracing, so
+	// recording never allocates; once the ring is full the oldest events are
+	// overwritten. Any thread may record. While tracing is off, recording costs
+	// one relaxed atomic load. Start, stop and write between frames, when no
+	// other thread is recording.
+	void StartTracing(size_t eventCapacity);
+	void StopTracing();
+	bool IsTracing();
+
+	// Writes the events in the ring, oldest first. Returns false if the file can't be written.
+	bool WriteTrace(const std::string& filePath);
+
+	// name and argName must be string literals or otherwise outlive the trace
+	void RecordTraceEvent(const char* name, std::chrono::steady_clock::time_point begin,
+		std::chrono::steady_clock::time_point end, const char* argName = nullptr, int arg = 0);
+
+	//+---------------------------------------------\
+	//|  TraceScope: records its lifetime           |
+	//\---------------------------------------------/
+	// For code outside the profiler's phases. If tracing starts or stops
+	// during the scope, nothing is recorded.
+	class TraceScope
+	{
+	public:
+		explicit TraceScope(const char* name, const char* argName = nullptr, int arg = 0)
+			: m_tracing{ IsTracing() }, m_name{ name }, m_argName{ argName }, m_arg{ arg }
+		{
+			if(m_tracing)
+				m_beginTime = std::chrono::steady_clock::now();
+		}
+		~TraceScope()
+		{
+			if(m_tracing && IsTracing())
+				RecordTraceEvent(m_name, m_beginTime, std::chrono::steady_clock::now(), m_argName, m_arg);
+		}
+		TraceScope(const TraceScope&) = delete;
+		TraceScope& operator=(const TraceScope&) = delete;
+
+	private:
+		bool m_tracing;
+		const char* m_name;
+		const char* m_argName;
+		int m_arg;
+		std::chrono::steady_clock::time_point m_beginTime;
+	};
+}
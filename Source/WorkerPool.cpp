@@ -0,0 +1,156 @@
+/**************************************************************************************\
+** File: WorkerPool.cpp
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Source code file for the WorkerPool class
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "WorkerPool.h"
+namespace Space
+{
+	namespace
+	{
+		// Set on worker threads so Submit can use the worker's own queue
+		thread_local const void* tls_poolPtr{ nullptr };
+		thread_local unsigned tls_workerIndex{ 0 };
+	}
+	WorkerPool::~WorkerPool()
+	{
+		Stop();
+	}
+	void WorkerPool::Start(unsigned numWorkers)
+	{
+		Stop();
+		if(numWorkers == 0)
+			return;
+
+		m_stopping = false;
+		m_numQueuedTasks = 0;
+		m_nextQueue = 0;
+		for(unsigned i = 0; i < numWorkers; ++i)
+		{
+			m_queues.push_back(std::make_unique<TaskQueue>());
+			m_queues.back()->tasks.resize(INITIAL_QUEUE_CAPACITY);
+		}
+		for(unsigned i = 0; i < numWorkers; ++i)
+			m_threads.emplace_back(&WorkerPool::WorkerLoop, this, i);
+	}
+	void WorkerPool::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_wakeMutex };
+			m_stopping = true;
+		}
+		m_wakeCondition.notify_all();
+		for(std::thread& thread : m_threads)
+			thread.join();
+		m_threads.clear();
+		m_queues.clear();
+	}
+	unsigned WorkerPool::GetNumWorkers() const
+	{
+		return (unsigned)m_threads.size();
+	}
+	void WorkerPool::Submit(const WorkerTask& task)
+	{
+		d2Assert(!m_queues.empty());
+		unsigned queueIndex;
+		if(tls_poolPtr == this)
+			queueIndex = tls_workerIndex;
+		else
+			queueIndex = m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+		TaskQueue& queue{ *m_queues[queueIndex] };
+		{
+			std::lock_guard<std::mutex> lock{ queue.mutex };
+			if(queue.count == queue.tasks.size())
+			{
+				// Unwrap into a bigger buffer
+				std::vector<WorkerTask> tasks(std::max(INITIAL_QUEUE_CAPACITY, queue.tasks.size() * 2));
+				for(size_t i = 0; i < queue.count; ++i)
+					tasks[i] = queue.tasks[(queue.front + i) % queue.tasks.size()];
+				queue.tasks.swap(tasks);
+				queue.front = 0;
+			}
+			queue.tasks[(queue.front + queue.count) % queue.tasks.size()] = task;
+			++queue.count;
+		}
+
+		// Lock so a worker can't miss the wakeup between checking the count and waiting
+		{
+			std::lock_guard<std::mutex> lock{ m_wakeMutex };
+			++m_numQueuedTasks;
+		}
+		m_wakeCondition.notify_one();
+	}
+	bool WorkerPool::RunPendingTask()
+	{
+		if(m_queues.empty())
+			return false;
+
+		WorkerTask task;
+		unsigned thiefIndex{ tls_poolPtr == this ? tls_workerIndex : 0 };
+		if(!StealTask(thiefIndex, task))
+			return false;
+		task.function(task.context, task.index);
+		return true;
+	}
+	//+-----------------\-----------------------------------------------------
+	//|   WorkerLoop	| (private)
+	//\-----------------/-----------------------------------------------------
+	// Runs tasks from the worker's own queue, then steals from the others.
+	// Sleeps only when no queue has work.
+	void WorkerPool::WorkerLoop(unsigned workerIndex)
+	{
+		tls_poolPtr = this;
+		tls_workerIndex = workerIndex;
+		for(;;)
+		{
+			WorkerTask task;
+			if(PopTask(workerIndex, task) || StealTask(workerIndex, task))
+			{
+				task.function(task.context, task.index);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock{ m_wakeMutex };
+			m_wakeCondition.wait(lock, [this] { return m_stopping || m_numQueuedTasks > 0; });
+			if(m_stopping)
+				return;
+		}
+	}
+	bool WorkerPool::PopTask(unsigned queueIndex, WorkerTask& taskOut)
+	{
+		TaskQueue& queue{ *m_queues[queueIndex] };
+		std::lock_guard<std::mutex> lock{ queue.mutex };
+		if(queue.count == 0)
+			return false;
+
+		// Newest first from the owner's end
+		--queue.count;
+		taskOut = queue.tasks[(queue.front + queue.count) % queue.tasks.size()];
+		--m_numQueuedTasks;
+		return true;
+	}
+	bool WorkerPool::StealTask(unsigned thiefIndex, WorkerTask& taskOut)
+	{
+		// Oldest first from the other end, starting with the thief's neighbor
+		for(size_t i = 1; i <= m_queues.size(); ++i)
+		{
+			TaskQueue& queue{ *m_queues[(thiefIndex + i) % m_queues.size()] };
+			std::lock_guard<std::mutex> lock{ queue.mutex };
+			if(queue.count == 0)
+				continue;
+
+			taskOut = queue.tasks[queue.front];
+			queue.front = (queue.front + 1) % queue.tasks.size();
+			--queue.count;
+			--m_numQueuedTasks;
+			return true;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,67 @@
+/**************************************************************************************\
+** File: WorkerPool.h
+** Project:
+** Author: David Leksen
+** Date:
+**
+** Header file for the WorkerPool class
+**
+\**************************************************************************************/
+#pragma once
+namespace Space
+{
+	// A unit of work. Plain function pointer and arguments, so submitting never allocates.
+	struct WorkerTask
+	{
+		void (*function)(void* context, size_t index);
+		void* context;
+		size_t index;
+	};
+
+	//+---------------------------------------------\
+	//|  WorkerPool: work-stealing thread pool      |
+	//\---------------------------------------------/
+	// Every worker owns a task queue. Workers take tasks from the back of their own
+	// queue and, when it is empty, steal from the front of the other queues.
+	// Tasks submitted from a worker go to that worker's queue; others are dealt
+	// round-robin. The thread waiting on results should call RunPendingTask()
+	// so it helps instead of sleeping.
+	class WorkerPool
+	{
+	public:
+		~WorkerPool();
+		void Start(unsigned numWorkers);
+		void Stop();
+		unsigned GetNumWorkers() const;
+
+		void Submit(const WorkerTask& task);
+
+		// Runs one queued task on the calling thread. Returns false if none was found.
+		bool RunPendingTask();
+
+	private:
+		// Each queue starts with room for this many tasks, which covers every system
+		// of an update step, so submitting doesn't allocate even on the first steps
+		static constexpr size_t INITIAL_QUEUE_CAPACITY{ 64 };
+
+		// Ring buffer that only grows, so steady-state use does not allocate
+		struct TaskQueue
+		{
+			std::mutex mutex;
+			std::vector<WorkerTask> tasks;
+			size_t front{ 0 };
+			size_t count{ 0 };
+		};
+		void WorkerLoop(unsigned workerIndex);
+		bool PopTask(unsigned queueIndex, WorkerTask& taskOut);
+		bool StealTask(unsigned thiefIndex, WorkerTask& taskOut);
+
+		std::vector<std::unique_ptr<TaskQueue>> m_queues;
+		std::vector<std::thread> m_threads;
+		std::mutex m_wakeMutex;
+		std::condition_variable m_wakeCondition;
+		std::atomic<size_t> m_numQueuedTasks{ 0 };
+		std::atomic<unsigned> m_nextQueue{ 0 };
+		bool m_stopping{ false };
+	};
+}
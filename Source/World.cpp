@@ -12,12 +12,24 @@
 #include "ParticleSystem.h"
 #include "Exceptions.h"
 #include "WorldDef.h"
+#include "AllocationCounter.h"
+#include "B2Allocator.h"
 
 namespace Space
 {
 	World::~World()
 	{
-		d2LogDebug << "World used " << m_highestActiveEntityCount << " / " << WORLD_MAX_ENTITIES << " entities. ";
+		d2LogDebug << "World used " << m_highestActiveEntityCount << " entities in " << m_entityGenerations.Size() << " slots, "
+			<< m_recycledEntityCount << " created in recycled slots. ";
+		if(m_b2WorldPtr)
+			LogLevelB2MemoryStats();
+		if(m_settings.wrapMode == WrapMode::CLONES)
+			d2LogDebug << "World used up to " << m_highestCloneBodyCount << " clone bodies at once. ";
+		if(IsAllocationCountingEnabled())
+			d2LogDebug << "World update steps allocated in " << m_allocatingStepCount << " of " << m_updateStepCount << " steps. ";
+		d2LogDebug << "World refreshed radars " << GetRadarRefreshesPerSecond() << " times per second. ";
+		d2LogDebug << "World reused projectile bodies " << m_projectilePoolHitCount << " times, created "
+			<< m_projectilePoolMissCount << " new ones. ";
 		if(m_b2WorldPtr)
 		{
 			delete m_b2WorldPtr;
@@ -26,22 +38,44 @@ namespace Space
 	}
 	void World::Init(const d2d::Rect& rect)
 	{
-		m_settings.LoadFrom("Data/world.hjson");
+		WorldDef settings;
+		settings.LoadFrom("Data/world.hjson");
+		Init(rect, settings);
+	}
+	void World::Init(const d2d::Rect& rect, const WorldDef& settings)
+	{
+		settings.Validate();
+		m_settings = settings;
+		m_contactEvents.Init(m_settings.contactEventCapacity);
 
-		// Destroy any existing Box2D physics world
+		// Destroy any existing Box2D physics world and release its memory in one go
 		m_timestepAccumulator = 0.0f;
 		if(m_b2WorldPtr)
 		{
+			LogLevelB2MemoryStats();
 			delete m_b2WorldPtr;
 			m_b2WorldPtr = nullptr;
 		}
+		ResetB2MemoryLevel();
+		m_cloneBodyCount = 0;
+		m_projectilePools.clear();
+		m_rayProjectiles.clear();
+		m_rayProjectiles.reserve(m_settings.rayProjectileCapacity);
 		m_destroyBuffer.clear();
-
-		// Clear components and flags
-		for(EntityID i = 0; i < WORLD_MAX_ENTITIES; ++i)
-			m_componentBits[i].reset();
-		for(EntityID i = 0; i < WORLD_MAX_ENTITIES; ++i)
-			m_flagBits[i].reset();
+		m_timerWheel.Clear();
+		m_bodyWriteEntityIDs.clear();
+		m_bodyWriteForcesX.clear();
+		m_bodyWriteForcesY.clear();
+		m_bodyWriteTorques.clear();
+		m_bodyWriteImpulsesX.clear();
+		m_bodyWriteImpulsesY.clear();
+		m_bodyWriteAngularImpulses.clear();
+
+		// Clear components and flags. Slot generations are kept so that
+		// entity IDs handed out before Init stay invalid.
+		while(!m_liveEntityIDs.empty())
+			RetireEntityID(m_liveEntityIDs.back());
+		ClearAllComponentData();
 
 		// Create new Box2D physics world
 		m_b2WorldPtr = new b2World{ b2Vec2_zero };
@@ -54,6 +88,9 @@ namespace Space
 		m_worldRect = rect;
 		m_worldDimensions = rect.GetDimensions();
 		m_worldCenter = rect.GetCenter();
+		m_spatialGrid.Init(rect, m_settings.spatialGridCellSize);
+		m_systemScheduler.SetNumWorkerThreads(m_settings.workerThreads);
+		AddSystems();
 
 		m_particleSystem.Init();
 
@@ -76,32 +113,87 @@ namespace Space
 	{
 		m_exitListenerPtr = listenerPtr;
 	}
+	//+-------------------\---------------------------------------
+	//|	   SetProfiler    |
+	//\-------------------/---------------------------------------
+	// Times the phases of the update step and Draw. Each system is timed
+	// under its own name as AddSystems adds it.
+	void World::SetProfiler(Profiler* profilerPtr)
+	{
+		m_profilerPtr = profilerPtr;
+		m_systemScheduler.SetProfiler(profilerPtr);
+		auto addPhase = [profilerPtr](const char* name)
+		{
+			return profilerPtr ? profilerPtr->AddPhase(name) : INVALID_PROFILER_PHASE_ID;
+		};
+		m_profilerPhases.updateStep = addPhase("World::SingleUpdateStep");
+		m_profilerPhases.destroyBuffer = addPhase("ProcessDestroyBuffer");
+		m_profilerPhases.bodyWrites = addPhase("FlushBodyWrites");
+		m_profilerPhases.saveStates = addPhase("SaveStates");
+		m_profilerPhases.syncClones = addPhase("SyncClones");
+		m_profilerPhases.b2WorldStep = addPhase("b2World::Step");
+		m_profilerPhases.bodyStates = addPhase("RefreshBodyStates");
+		m_profilerPhases.contactEvents = addPhase("ProcessContactEvents");
+		m_profilerPhases.wrap = addPhase("Wrap");
+		m_profilerPhases.spatialGrid = addPhase("UpdateSpatialGrid");
+		m_profilerPhases.draw = addPhase("World::Draw");
+	}
 	//+------------------------\----------------------------------
 	//|	  Creating Entities    |
 	//\------------------------/----------------------------------
 	EntityID World::NewEntityID(const b2Vec2& size, int drawLayer, bool activate)
 	{
-		for(EntityID entityID = 0; entityID < WORLD_MAX_ENTITIES; ++entityID)
-			if(m_componentBits[entityID].none() && m_flagBits[entityID].none())
-			{
-				m_sizeComponents[entityID] = size;
-				m_boundingRadiusComponents[entityID] = size.Length() * 0.5f;
+		// Reuse a freed slot if there is one, otherwise add a new slot
+		EntityID index;
+		if(!m_freeEntityIndices.empty())
+		{
+			index = m_freeEntityIndices.back();
+			m_freeEntityIndices.pop_back();
+			++m_recycledEntityCount;
+		}
+		else
+		{
+			index = m_entityGenerations.Size();
+			if(index >= ENTITY_INDEX_MASK)
+				throw GameException{ "World ran out of entities" };
+			GrowEntityArrays(index + 1);
+		}
 
-				if(activate)
-					Activate(entityID);
+		// Odd generation marks the slot as in use
+		m_entityGenerations[index] = (m_entityGenerations[index] + 1) & ENTITY_INDEX_MASK;
+		EntityID entityID{ MakeEntityID(index, m_entityGenerations[index]) };
+		m_liveEntityPositions[index] = m_liveEntityIDs.size();
+		m_liveEntityIDs.push_back(entityID);
 
-				m_drawAnimationComponents[entityID].layer = drawLayer;
-				return entityID;
-			}
-		throw GameException{ "World ran out of entities" };
+		m_sizeComponents[entityID] = size;
+		m_boundingRadiusComponents[entityID] = size.Length() * 0.5f;
+
+		if(activate)
+			Activate(entityID);
+
+		m_drawLayers[entityID] = drawLayer;
+		return entityID;
+	}
+	//+-------------------------\---------------------------------
+	//|	 LogLevelB2MemoryStats	 | (private)
+	//\-------------------------/
+	//	Box2D memory used since the last Init, logged before the
+	//	b2World is deleted so bytes shows what the level still held
+	//+-------------------------------------------------------------
+	void World::LogLevelB2MemoryStats() const
+	{
+		B2MemoryStats stats{ GetB2MemoryStats() };
+		d2LogDebug << "Box2D level memory: " << stats.bytes << " bytes in use, " << stats.peakBytes << " peak, "
+			<< stats.allocationCount << " allocations (" << stats.largeAllocationCount << " large), "
+			<< stats.arenaBytes << " arena bytes. ";
 	}
 	void World::Destroy(EntityID id)
 	{
-		m_destroyBuffer.insert(id);
+		m_destroyBuffer.push_back(id);
 	}
 	void World::SetFlag(EntityID entityID, FlagBit flagBit, bool enable)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		if(enable)
 			m_flagBits[entityID].set(flagBit);
 		else
@@ -109,7 +201,7 @@ namespace Space
 	}
 	void World::SetFlagSet(EntityID entityID, FlagBitset flagBits, bool enable)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		if(enable)
 			m_flagBits[entityID] |= flagBits;
 		else
@@ -117,45 +209,46 @@ namespace Space
 	}
 	void World::RemoveAllFlags(EntityID entityID)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		m_flagBits[entityID].reset();
 	}
 	void World::RemoveComponent(EntityID entityID, ComponentBit componentBit)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		if(componentBit == COMPONENT_PHYSICS)
 			DestroyB2Bodies(entityID);
-		m_componentBits[entityID].reset(componentBit);
+		ResetComponentBit(entityID, componentBit);
 	}
 	void World::RemoveComponentSet(EntityID entityID, ComponentBitset componentBits)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		if(componentBits[COMPONENT_PHYSICS])
 			DestroyB2Bodies(entityID);
-		m_componentBits[entityID] &= ~componentBits;
+		ResetComponentBits(entityID, componentBits);
 	}
 	void World::RemoveAllComponents(EntityID entityID)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		DestroyB2Bodies(entityID);
-		m_componentBits[entityID].reset();
+		ResetComponentBits(entityID, m_componentBits[entityID]);
 	}
 	void World::DestroyB2Bodies(EntityID entityID)
 	{
 		if(HasPhysics(entityID))
 		{
-			m_b2WorldPtr->DestroyBody(m_physicsComponents[entityID].mainBody.b2BodyPtr);
+			if(m_projectilePoolIndices.Contains(entityID))
+				ReturnProjectileBody(entityID);
+			else
+				m_b2WorldPtr->DestroyBody(m_physicsComponents[entityID].mainBody.b2BodyPtr);
 			m_physicsComponents[entityID].mainBody.b2BodyPtr = nullptr;
 			for(CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-			{
-				m_b2WorldPtr->DestroyBody(cloneBody.b2BodyPtr);
-				cloneBody.b2BodyPtr = nullptr;
-			}
+				if(cloneBody.b2BodyPtr)
+					DestroyCloneBody(cloneBody);
 		}
 	}
 	//void World::RemoveAllComponentsExcept(EntityID entityID, BitMask componentBits)
 	//{
-	//	d2Assert(entityID < WORLD_MAX_ENTITIES);
+	//	d2Assert(IsValidEntityID(entityID));
 	//	m_componentBits[entityID].reset();
 	//	m_componentBits[entityID] |= componentBits;
 	//}
@@ -168,10 +261,11 @@ namespace Space
 		b2Vec2 position;
 		bool acceptablePositionFound{ false };
 		unsigned attempts{ 0 };
+		std::vector<std::pair<EntityID, float>> closestEntities;
 		do
 		{
 			position = d2d::RandomVec2InRect(m_worldRect);
-			auto closestEntities = GetClosestEntities(position, newBoundingRadius, 1);
+			GetClosestEntities(position, newBoundingRadius, 1, closestEntities);
 			if(closestEntities.empty() || closestEntities.front().second >= minGap)
 				acceptablePositionFound = true;
 		} while(!acceptablePositionFound && ++attempts < maxAttempts);
@@ -184,10 +278,7 @@ namespace Space
 	void World::AddPhysicsComponent(EntityID entityID, b2BodyType type,
 		const InstanceDef& def, bool fixedRotation, bool continuousCollisionDetection)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_PHYSICS);
-
-		// Create main body
+		d2Assert(IsValidEntityID(entityID));
 		b2BodyDef bodyDef;
 		bodyDef.type = type;
 		bodyDef.awake = IsActive(entityID);
@@ -197,24 +288,34 @@ namespace Space
 		bodyDef.angularVelocity = def.angularVelocity;
 		bodyDef.fixedRotation = fixedRotation;
 		bodyDef.bullet = continuousCollisionDetection;
+		AttachMainBody(entityID, m_b2WorldPtr->CreateBody(&bodyDef));
+	}
+	// Sets up the physics component around a b2Body that is already placed and moving
+	void World::AttachMainBody(EntityID entityID, b2Body* b2BodyPtr)
+	{
+		SetComponentBit(entityID, COMPONENT_PHYSICS);
+		m_physicsComponents.Insert(entityID);
+		m_physicsWrapDatas.Insert(entityID);
+		m_lastTransforms.Insert(entityID);
+		m_smoothedTransforms.Insert(entityID);
+		m_lastLinearVelocities.Insert(entityID);
+
 		m_physicsComponents[entityID].mainBody.entityID = entityID;
 		m_physicsComponents[entityID].mainBody.isClone = false;
-		SetB2BodyPtr(&m_physicsComponents[entityID].mainBody, m_b2WorldPtr->CreateBody(&bodyDef));
+		SetB2BodyPtr(&m_physicsComponents[entityID].mainBody, b2BodyPtr);
+		m_bodyStates.Store(entityID, m_physicsComponents[entityID].mainBody.b2BodyPtr);
 
-		// Create clones
+		// Set up clones. Their b2Bodies are created by SyncClones once the entity nears
+		// the world edge; until then only the section is used, for drawing.
 		CloneSectionList cloneLocationList{ GetCloneSectionList(*m_physicsComponents[entityID].mainBody.b2BodyPtr) };
 		unsigned i{ 0 };
 		for(CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
 		{
-			// Set clone body
 			cloneBody.entityID = entityID;
 			cloneBody.isClone = true;
 			cloneBody.cloneIndex = i;
 			cloneBody.section = cloneLocationList.at(i);
-
-			// Create clone body
-			bodyDef.position = def.position + GetCloneOffset(cloneLocationList.at(i));
-			SetB2BodyPtr(&cloneBody, m_b2WorldPtr->CreateBody(&bodyDef));
+			cloneBody.b2BodyPtr = nullptr;
 
 			// Traverse clone location list at the same time
 			++i;
@@ -230,11 +331,12 @@ namespace Space
 		m_lastTransforms[entityID] = m_physicsComponents[entityID].mainBody.b2BodyPtr->GetTransform();
 		m_smoothedTransforms[entityID] = m_lastTransforms[entityID];
 		m_lastLinearVelocities[entityID] = m_physicsComponents[entityID].mainBody.b2BodyPtr->GetLinearVelocity();
+		m_spatialGrid.Update(entityID, b2BodyPtr->GetPosition(), m_boundingRadiusComponents[entityID]);
 	}
 	std::vector<b2Fixture*> World::AddCircleShape(EntityID entityID, const d2d::Material& material, const d2d::Filter& filter,
 		float sizeRelativeToWidth, const b2Vec2& position, bool isSensor)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		std::vector<b2Fixture*> fixturePtrList;
 		if(HasPhysics(entityID) && HasSize2D(entityID))
 		{
@@ -243,10 +345,13 @@ namespace Space
 			b2Fixture* fixturePtr = m_shapeFactory.AddCircleShape(*m_physicsComponents[entityID].mainBody.b2BodyPtr, 
 				size, material, filter, isSensor, position);
 			fixturePtrList.push_back(fixturePtr);
+			m_bodyStates.Store(entityID, m_physicsComponents[entityID].mainBody.b2BodyPtr);
 
 			// Add to clones
 			for(unsigned i = 0; i < WORLD_NUM_CLONES; ++i)
 			{
+				if(!m_physicsComponents[entityID].cloneBodyList[i].b2BodyPtr)
+					continue;
 				fixturePtr = m_shapeFactory.AddCircleShape(*m_physicsComponents[entityID].cloneBodyList[i].b2BodyPtr, 
 					size, material, filter, isSensor, position);
 				fixturePtrList.push_back(fixturePtr);
@@ -257,7 +362,7 @@ namespace Space
 	std::vector<b2Fixture*> World::AddRectShape(EntityID entityID, const d2d::Material& material, const d2d::Filter& filter,
 		const b2Vec2& relativeSize, bool isSensor, const b2Vec2& position, float angle)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		std::vector<b2Fixture*> fixturePtrList;
 		if(HasPhysics(entityID) && HasSize2D(entityID))
 		{
@@ -266,10 +371,13 @@ namespace Space
 			b2Fixture* fixturePtr = m_shapeFactory.AddRectShape(*m_physicsComponents[entityID].mainBody.b2BodyPtr, 
 				size, material, filter, isSensor, position, angle);
 			fixturePtrList.push_back(fixturePtr);
+			m_bodyStates.Store(entityID, m_physicsComponents[entityID].mainBody.b2BodyPtr);
 
 			// Add to clones
 			for(unsigned i = 0; i < WORLD_NUM_CLONES; ++i)
 			{
+				if(!m_physicsComponents[entityID].cloneBodyList[i].b2BodyPtr)
+					continue;
 				fixturePtr = m_shapeFactory.AddRectShape(*m_physicsComponents[entityID].cloneBodyList[i].b2BodyPtr, size,
 					material, filter, isSensor, position, angle);
 				fixturePtrList.push_back(fixturePtr);
@@ -281,17 +389,20 @@ namespace Space
 		const d2d::Material& material, const d2d::Filter& filter, bool isSensor,
 		const b2Vec2& position, float angle)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		std::vector<b2Fixture*> fixturePtrList;
 		if(HasPhysics(entityID) && HasSize2D(entityID))
 		{
 			// Add to main body
 			fixturePtrList = m_shapeFactory.AddShapes(*m_physicsComponents[entityID].mainBody.b2BodyPtr, m_sizeComponents[entityID], model,
 				material, filter, isSensor, position, angle);
+			m_bodyStates.Store(entityID, m_physicsComponents[entityID].mainBody.b2BodyPtr);
 
 			// Add to clones
 			for(unsigned i = 0; i < WORLD_NUM_CLONES; ++i)
 			{
+				if(!m_physicsComponents[entityID].cloneBodyList[i].b2BodyPtr)
+					continue;
 				std::vector<b2Fixture*> cloneFixturePtrList;
 				m_shapeFactory.AddShapes(*m_physicsComponents[entityID].cloneBodyList[i].b2BodyPtr, m_sizeComponents[entityID], model,
 					material, filter, isSensor, position, angle);
@@ -305,41 +416,46 @@ namespace Space
 	//\------------------------/----------------------------------
 	void World::AddDrawRadarComponent(EntityID entityID, const DrawRadarComponent& radarComponent)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_DRAW_ON_RADAR);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_DRAW_ON_RADAR);
+		m_drawRadarComponents.Insert(entityID);
 		m_drawRadarComponents[entityID] = radarComponent;
 	}
 	void World::AddDrawFixturesComponent(EntityID entityID, const DrawFixturesComponent& fixturesComponent)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_DRAW_FIXTURES);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_DRAW_FIXTURES);
+		m_drawFixtureComponents.Insert(entityID);
 		m_drawFixtureComponents[entityID] = fixturesComponent;
 	}
 	void World::AddDrawAnimationComponent(EntityID entityID, const d2d::AnimationDef& animationDef)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_DRAW_ANIMATION);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_DRAW_ANIMATION);
+		m_drawAnimationComponents.Insert(entityID);
 		m_drawAnimationComponents[entityID].animation.Init(animationDef);
 	}
 	void World::SetAnimationLayer(EntityID entityID, int layer)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		d2d::Clamp(layer, m_settings.drawLayerRange);
-		m_drawAnimationComponents[entityID].layer = layer;
+		m_drawLayers[entityID] = layer;
 	}
 	//+------------------------\----------------------------------
 	//|		  Power-ups		   |
 	//\------------------------/----------------------------------
 	void World::AddPowerUpComponent(EntityID entityID, const PowerUpComponent& powerUp)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_POWERUP);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_POWERUP);
+		m_powerUpComponents.Insert(entityID);
 		m_powerUpComponents[entityID] = powerUp;
 	}
 	void World::AddIconCollectorComponent(EntityID entityID, float* creditsPtr)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_ICON_COLLECTOR);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_ICON_COLLECTOR);
+		m_iconCollectorComponents.Insert(entityID);
 		m_iconCollectorComponents[entityID].creditsPtr = creditsPtr;
 	}
 	//+--------------------\--------------------------------------
@@ -347,16 +463,18 @@ namespace Space
 	//\--------------------/--------------------------------------
 	void World::AddHealthComponent(EntityID entityID, float maxHP)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_HEALTH);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_HEALTH);
+		m_healthComponents.Insert(entityID);
 		m_healthComponents[entityID].hpMax = maxHP;
 		m_healthComponents[entityID].hp = maxHP;
 		m_healthComponents[entityID].deathDamage = 0.0f;
 	}
 	void World::AddParentComponent(EntityID entityID, EntityID parentID)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_PARENT);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_PARENT);
+		m_parentComponents.Insert(entityID);
 		m_parentComponents[entityID] = parentID;
 	}
 	void World::AddParticleExplosionOnDeathComponent(EntityID entityID, float relativeSize,
@@ -364,8 +482,9 @@ namespace Space
 		const d2d::Range<int>& sizeIndexRange, const d2d::ColorRange& colorRange,
 		float lifetime, float fadeIn, float fadeOut)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_PARTICLE_EXPLOSION);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_PARTICLE_EXPLOSION);
+		m_particleExplosionComponents.Insert(entityID);
 		m_particleExplosionComponents[entityID].relativeSize = relativeSize;
 		m_particleExplosionComponents[entityID].numParticles = numParticles;
 		m_particleExplosionComponents[entityID].speedRange = speedRange;
@@ -378,20 +497,23 @@ namespace Space
 	}
 	void World::AddDestructionDelayComponent(EntityID entityID, float delay)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_DESTRUCTION_DELAY);
-		m_destructionDelayComponents[entityID] = std::max(delay, 0.0f);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_DESTRUCTION_DELAY);
+		m_timerWheel.Cancel(m_destructionDelayComponents.Insert(entityID));
+		m_destructionDelayComponents[entityID] = ScheduleTimer(delay, { WorldTimerType::DESTRUCTION_DELAY, entityID });
 	}
 	void World::AddDestructionDelayOnContactComponent(EntityID entityID, float delay)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_DESTRUCTION_DELAY_ON_CONTACT);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_DESTRUCTION_DELAY_ON_CONTACT);
+		m_destructionDelayOnContactComponents.Insert(entityID);
 		m_destructionDelayOnContactComponents[entityID] = std::max(delay, 0.0f);
 	}
 	void World::AddDestructionChanceOnContactComponent(EntityID entityID, float destructionChance)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_DESTRUCTION_CHANCE_ON_CONTACT);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_DESTRUCTION_CHANCE_ON_CONTACT);
+		m_destructionChanceOnContactComponents.Insert(entityID);
 		m_destructionChanceOnContactComponents[entityID] = std::clamp(destructionChance, 0.0f, 1.0f);
 	}
 	//+---------------------------\-------------------------------
@@ -399,22 +521,26 @@ namespace Space
 	//\---------------------------/-------------------------------
 	void World::AddProjectileLauncherComponent(EntityID entityID, unsigned numSlots, bool secondaryLaunchers)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		d2Assert(numSlots <= WORLD_MAX_PROJECTILE_LAUNCHER_SLOTS);
-		m_componentBits[entityID].set(secondaryLaunchers ? COMPONENT_SECONDARY_PROJECTILE_LAUNCHER : COMPONENT_PRIMARY_PROJECTILE_LAUNCHER);
+		SetComponentBit(entityID, secondaryLaunchers ? COMPONENT_SECONDARY_PROJECTILE_LAUNCHER : COMPONENT_PRIMARY_PROJECTILE_LAUNCHER);
 
 		ProjectileLauncherComponent* launcherComponentPtr{
-			secondaryLaunchers ? &m_secondaryProjectileLauncherComponents[entityID] : &m_primaryProjectileLauncherComponents[entityID] };
+			secondaryLaunchers ? &m_secondaryProjectileLauncherComponents.Insert(entityID) : &m_primaryProjectileLauncherComponents.Insert(entityID) };
 
 		launcherComponentPtr->factor = 0.0f;
 		launcherComponentPtr->numSlots = numSlots;
 		for(unsigned i = 0; i < WORLD_MAX_PROJECTILE_LAUNCHER_SLOTS; ++i)
+		{
 			launcherComponentPtr->projectileLaunchers[i].enabled = false;
+			m_timerWheel.Cancel(launcherComponentPtr->projectileLaunchers[i].readyTimerID);
+			launcherComponentPtr->projectileLaunchers[i].readyTimerID = INVALID_TIMER_ID;
+		}
 	}
 	void World::AddProjectileLauncher(EntityID entityID, unsigned slot, const ProjectileDef& projectileDef,
 		const b2Vec2& localRelativePosition, float impulse, float interval, bool temporarilyDisabled, bool secondaryLaunchers)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		if(IsValidProjectileLauncherSlot(entityID, slot, secondaryLaunchers))
 		{
 			ProjectileLauncherComponent* launcherComponentPtr{
@@ -425,12 +551,14 @@ namespace Space
 			launcherComponentPtr->projectileLaunchers[slot].localRelativePosition = localRelativePosition;
 			launcherComponentPtr->projectileLaunchers[slot].impulse = impulse;
 			launcherComponentPtr->projectileLaunchers[slot].interval = interval;
-			launcherComponentPtr->projectileLaunchers[slot].intervalAccumulator = interval;
+			launcherComponentPtr->projectileLaunchers[slot].ready = true;
+			m_timerWheel.Cancel(launcherComponentPtr->projectileLaunchers[slot].readyTimerID);
+			launcherComponentPtr->projectileLaunchers[slot].readyTimerID = INVALID_TIMER_ID;
 		}
 	}
 	void World::RemoveProjectileLauncher(EntityID entityID, unsigned slot, bool secondaryLaunchers)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		if(IsValidProjectileLauncherSlot(entityID, slot, secondaryLaunchers))
 		{
 			ProjectileLauncherComponent* launcherComponentPtr{
@@ -440,11 +568,13 @@ namespace Space
 	}
 	bool World::IsValidProjectileLauncherSlot(EntityID entityID, unsigned slot, bool secondaryLaunchers) const
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		const ProjectileLauncherComponent* launcherComponentPtr{
-			secondaryLaunchers ? &m_secondaryProjectileLauncherComponents[entityID] : &m_primaryProjectileLauncherComponents[entityID] };
+		d2Assert(IsValidEntityID(entityID));
 		ComponentBit component{ secondaryLaunchers ? COMPONENT_SECONDARY_PROJECTILE_LAUNCHER : COMPONENT_PRIMARY_PROJECTILE_LAUNCHER };
-		return HasComponent(entityID, component) && slot < launcherComponentPtr->numSlots;
+		if(!HasComponent(entityID, component))
+			return false;
+		const ProjectileLauncherComponent& launcherComponent{
+			secondaryLaunchers ? m_secondaryProjectileLauncherComponents[entityID] : m_primaryProjectileLauncherComponents[entityID] };
+		return slot < launcherComponent.numSlots;
 	}
 	//+--------------------------\--------------------------------
 	//|	    LaunchProjectile     |
@@ -452,16 +582,24 @@ namespace Space
 	EntityID World::LaunchProjectile(const ProjectileDef& projectileDef, const b2Vec2& position,
 		float angle, float impulse, const b2Vec2& parentVelocity, EntityID parentID)
 	{
+		if(projectileDef.sweptRay)
+		{
+			LaunchRayProjectile(projectileDef, position, angle, impulse, parentVelocity, parentID);
+			return INVALID_ENTITY_ID;
+		}
+
 		EntityID id{ NewEntityID(projectileDef.dimensions, GetDrawLayer(parentID) - 1, true) };
 		InstanceDef def;
 		def.position = position;
 		def.angle = angle;
 		def.velocity = parentVelocity;
 		def.angularVelocity = 0.0f;
-		AddPhysicsComponent(id, b2_dynamicBody, def,
-			projectileDef.fixedRotation, projectileDef.continuousCollisionDetection);
-
-		AddShapes(id, projectileDef.model.name, projectileDef.material, projectileDef.filter);
+		if(!TakePooledProjectileBody(id, projectileDef, def))
+		{
+			AddPhysicsComponent(id, b2_dynamicBody, def,
+				projectileDef.fixedRotation, projectileDef.continuousCollisionDetection);
+			AddShapes(id, projectileDef.model.name, projectileDef.material, projectileDef.filter);
+		}
 
 		if(impulse > 0.0f)
 		{
@@ -497,14 +635,119 @@ namespace Space
 
 		return id;
 	}
+	void World::LaunchRayProjectile(const ProjectileDef& projectileDef, const b2Vec2& position,
+		float angle, float impulse, const b2Vec2& parentVelocity, EntityID parentID)
+	{
+		// Mass and filter come from the same shapes a body projectile would get
+		ProjectilePool& pool{ m_projectilePools[GetProjectilePoolIndex(projectileDef)] };
+		if(!pool.hasRayData)
+		{
+			b2BodyDef bodyDef;
+			bodyDef.type = b2_dynamicBody;
+			bodyDef.enabled = false;
+			b2Body* b2BodyPtr{ m_b2WorldPtr->CreateBody(&bodyDef) };
+			m_shapeFactory.AddShapes(*b2BodyPtr, projectileDef.dimensions, projectileDef.model.name,
+				projectileDef.material, projectileDef.filter, false, b2Vec2_zero, 0.0f);
+			pool.rayMass = b2BodyPtr->GetMass();
+			if(b2BodyPtr->GetFixtureList())
+				pool.rayFilter = b2BodyPtr->GetFixtureList()->GetFilterData();
+			m_b2WorldPtr->DestroyBody(b2BodyPtr);
+			pool.hasRayData = true;
+		}
+
+		RayProjectile& ray{ m_rayProjectiles.emplace_back() };
+		ray.poolIndex = &pool - m_projectilePools.data();
+		ray.parentID = parentID;
+		ray.size = projectileDef.dimensions;
+		ray.drawLayer = GetDrawLayer(parentID) - 1;
+		ray.position = ray.lastPosition = ray.smoothedPosition = position;
+		ray.angle = angle;
+		ray.velocity = parentVelocity;
+		if(impulse > 0.0f && pool.rayMass > 0.0f)
+			ray.velocity += (impulse / pool.rayMass) * b2Vec2{ cos(angle), sin(angle) };
+		ray.acceleration = 0.0f;
+		ray.accelerationSecondsLeft = 0.0f;
+		if(projectileDef.acceleration > 0.0f && projectileDef.accelerationTime > 0.0f)
+		{
+			ray.acceleration = projectileDef.acceleration;
+			ray.accelerationSecondsLeft = projectileDef.accelerationTime;
+		}
+		ray.secondsLeft = projectileDef.destructionDelay ?
+			projectileDef.destructionDelayTime : std::numeric_limits<float>::max();
+		ray.ignoreParent = projectileDef.ignoreParentCollisionsUntilFirstContactEnd;
+		ray.touchingParent = false;
+		ray.animation.Init(projectileDef.model.animationDef);
+
+		// Notify listener
+		if(m_projectileLauncherListenerPtr)
+			m_projectileLauncherListenerPtr->ProjectileLaunched(projectileDef, parentID);
+	}
+	// Projectiles share a pool when their bodies and fixtures would come out the same
+	size_t World::GetProjectilePoolIndex(const ProjectileDef& projectileDef)
+	{
+		const d2d::Material& material{ projectileDef.material };
+		const d2d::Filter& filter{ projectileDef.filter };
+		for(size_t i = 0; i < m_projectilePools.size(); ++i)
+		{
+			const ProjectilePool& pool{ m_projectilePools[i] };
+			if(pool.modelName == projectileDef.model.name &&
+				pool.dimensions == projectileDef.dimensions &&
+				pool.fixedRotation == projectileDef.fixedRotation &&
+				pool.continuousCollisionDetection == projectileDef.continuousCollisionDetection &&
+				pool.material.density == material.density &&
+				pool.material.friction == material.friction &&
+				pool.material.restitution == material.restitution &&
+				pool.filter.categoryBits == filter.categoryBits &&
+				pool.filter.maskBits == filter.maskBits &&
+				pool.filter.groupIndex == filter.groupIndex)
+				return i;
+		}
+		m_projectilePools.push_back({ projectileDef.model.name, projectileDef.dimensions,
+			projectileDef.fixedRotation, projectileDef.continuousCollisionDetection, material, filter });
+		return m_projectilePools.size() - 1;
+	}
+	// Gives the new projectile a pooled body if there is one. Either way the entity is
+	// tied to the pool, so its main body is returned there when it is destroyed.
+	bool World::TakePooledProjectileBody(EntityID entityID, const ProjectileDef& projectileDef, const InstanceDef& def)
+	{
+		size_t poolIndex{ GetProjectilePoolIndex(projectileDef) };
+		m_projectilePoolIndices.Insert(entityID) = poolIndex;
+		std::vector<b2Body*>& b2BodyPtrs{ m_projectilePools[poolIndex].b2BodyPtrs };
+		if(b2BodyPtrs.empty())
+		{
+			++m_projectilePoolMissCount;
+			return false;
+		}
+		++m_projectilePoolHitCount;
+
+		b2Body* b2BodyPtr{ b2BodyPtrs.back() };
+		b2BodyPtrs.pop_back();
+		b2BodyPtr->SetTransform(def.position, def.angle);
+		b2BodyPtr->SetLinearVelocity(def.velocity);
+		b2BodyPtr->SetAngularVelocity(def.angularVelocity);
+		b2BodyPtr->SetAwake(IsActive(entityID));
+		b2BodyPtr->SetEnabled(IsActive(entityID));
+		AttachMainBody(entityID, b2BodyPtr);
+		return true;
+	}
+	// Disabling the body ends its contacts and takes it out of the broad-phase
+	void World::ReturnProjectileBody(EntityID entityID)
+	{
+		b2Body* b2BodyPtr{ m_physicsComponents[entityID].mainBody.b2BodyPtr };
+		b2BodyPtr->SetEnabled(false);
+		b2BodyPtr->GetUserData().pointer = 0;
+		m_projectilePools[m_projectilePoolIndices[entityID]].b2BodyPtrs.push_back(b2BodyPtr);
+		m_projectilePoolIndices.Erase(entityID);
+	}
 	//+----------------------\------------------------------------
 	//|	   Getting around	 |
 	//\----------------------/------------------------------------
 	void World::AddThrusterComponent(EntityID entityID, unsigned numSlots, float initialFactor)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		d2Assert(numSlots <= WORLD_MAX_THRUSTER_SLOTS);
-		m_componentBits[entityID].set(COMPONENT_THRUSTER);
+		SetComponentBit(entityID, COMPONENT_THRUSTER);
+		m_thrusterComponents.Insert(entityID);
 
 		ThrusterComponent& thrusterComponent{ m_thrusterComponents[entityID] };
 		thrusterComponent.factor = initialFactor;
@@ -515,7 +758,7 @@ namespace Space
 	void World::AddThruster(EntityID entityID, unsigned slot, const d2d::AnimationDef& animationDef,
 		float acceleration, float fuelPerSecond, const b2Vec2& localRelativePosition)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		d2Assert(IsValidThrusterSlot(entityID, slot));
 		m_thrusterComponents[entityID].thrusters[slot].enabled = true;
 		m_thrusterComponents[entityID].thrusters[slot].animation.Init(animationDef);
@@ -525,90 +768,250 @@ namespace Space
 	}
 	void World::RemoveThruster(EntityID entityID, unsigned slot)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		d2Assert(IsValidThrusterSlot(entityID, slot));
-		m_primaryProjectileLauncherComponents[entityID].projectileLaunchers[slot].enabled = false;
+		m_thrusterComponents[entityID].thrusters[slot].enabled = false;
 	}
 	bool World::IsValidThrusterSlot(EntityID entityID, unsigned slot) const
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		return (HasComponent(entityID, COMPONENT_THRUSTER) &&
 			slot < m_thrusterComponents[entityID].numSlots);
 	}
 	void World::AddSetThrustFactorAfterDelayComponent(EntityID entityID, float thrustFactor, float delay)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_SET_THRUST_AFTER_DELAY);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_SET_THRUST_AFTER_DELAY);
+		m_timerWheel.Cancel(m_setThrustFactorAfterDelayComponents.Insert(entityID).timerID);
 		m_setThrustFactorAfterDelayComponents[entityID].factor = thrustFactor;
-		m_setThrustFactorAfterDelayComponents[entityID].delay = delay;
+		m_setThrustFactorAfterDelayComponents[entityID].timerID = ScheduleTimer(delay, { WorldTimerType::SET_THRUST_FACTOR, entityID });
 	}
 
 	void World::AddBoosterComponent(EntityID entityID, float factor, float boostSeconds, float cooldownSeconds)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_BOOSTER);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_BOOSTER);
+		m_timerWheel.Cancel(m_boosterComponents.Insert(entityID).timerID);
 		m_boosterComponents[entityID].factor = factor;
 		m_boosterComponents[entityID].boostSeconds = boostSeconds;
 		m_boosterComponents[entityID].cooldownSeconds = cooldownSeconds;
 
 		m_boosterComponents[entityID].engaged = false;
-		m_boosterComponents[entityID].secondsLeft = 0.0f;
-		m_boosterComponents[entityID].cooldownSecondsLeft = 0.0f;
+		m_boosterComponents[entityID].boosting = false;
+		m_boosterComponents[entityID].coolingDown = false;
+		m_boosterComponents[entityID].timerID = INVALID_TIMER_ID;
 	}
 	void World::AddFuelComponent(EntityID entityID, float level, float max)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_FUEL);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_FUEL);
+		m_fuelComponents.Insert(entityID);
 		m_fuelComponents[entityID].max = max;
 		m_fuelComponents[entityID].level = level;
 	}
 	void World::AddRotatorComponent(EntityID entityID, float rotationSpeed)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_ROTATOR);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_ROTATOR);
+		m_rotatorComponents.Insert(entityID);
 		m_rotatorComponents[entityID].factor = 0.0f;
 		m_rotatorComponents[entityID].lastFactor = 0.0f;
 		m_rotatorComponents[entityID].rotationSpeed = rotationSpeed;
 	}
 	void World::AddBrakeComponent(EntityID entityID, float deceleration)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_BRAKE);
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_BRAKE);
+		m_brakeComponents.Insert(entityID);
 		m_brakeComponents[entityID].factor = 0.0f;
 		m_brakeComponents[entityID].deceleration = deceleration;
 	}
 	void World::AddRadarComponent(EntityID entityID, float range)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
+		d2Assert(IsValidEntityID(entityID));
 		if(HasPhysics(entityID))
 		{
-			m_componentBits[entityID].set(COMPONENT_RADAR);
+			if(HasComponent(entityID, COMPONENT_RADAR))
+				m_timerWheel.Cancel(m_radarComponents[entityID].refreshTimerID);
+			SetComponentBit(entityID, COMPONENT_RADAR);
+			m_radarComponents.Insert(entityID);
 			m_radarComponents[entityID].range = range;
-			m_radarComponents[entityID].bodiesInRange.clear();
-			CreateRadarFixture(entityID);
+			RefreshRadar(entityID);
+			m_radarComponents[entityID].refreshTimerID = ScheduleTimer(1.0f / m_settings.radarRefreshesPerSecond,
+				{ WorldTimerType::RADAR_REFRESH, entityID });
+		}
+	}
+	//+------------------------\----------------------------------
+	//|	     Entity index	   |
+	//\------------------------/----------------------------------
+	void World::SetComponentBit(EntityID entityID, ComponentBit componentBit)
+	{
+		d2Assert(IsValidEntityID(entityID));
+		m_componentBits[entityID].set(componentBit);
+	}
+	void World::ResetComponentBit(EntityID entityID, ComponentBit componentBit)
+	{
+		d2Assert(IsValidEntityID(entityID));
+		if(m_componentBits[entityID].test(componentBit))
+		{
+			m_componentBits[entityID].reset(componentBit);
+			EraseComponentData(entityID, componentBit);
 		}
 	}
-	void World::CreateRadarFixture(EntityID entityID)
+	void World::ResetComponentBits(EntityID entityID, ComponentBitset componentBits)
 	{
-		// Add to main body
-		b2Fixture* b2FixturePtr = m_shapeFactory.AddCircleShape(
-			*m_physicsComponents[entityID].mainBody.b2BodyPtr,
-			m_radarComponents[entityID].range * 2.0f, {}, {}, true, b2Vec2_zero);
-		b2FixturePtr->GetUserData().isRadar = true;
-		m_radarComponents[entityID].b2FixturePtr = b2FixturePtr;
+		for(size_t bit = 0; bit < COMPONENT_NUM_BITS; ++bit)
+			if(componentBits.test(bit))
+				ResetComponentBit(entityID, (ComponentBit)bit);
 	}
-	void World::MoveRadarToMainBody(EntityID entityID)
+	void World::EraseComponentData(EntityID entityID, ComponentBit componentBit)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		if(HasPhysics(entityID) && HasComponent(entityID, COMPONENT_RADAR))
+		CancelComponentTimers(entityID, componentBit);
+		switch(componentBit)
 		{
-			Body* bodyPtr = GetUserBodyFromFixture(m_radarComponents[entityID].b2FixturePtr);
-			if(bodyPtr->b2BodyPtr != m_physicsComponents[entityID].mainBody.b2BodyPtr)
-			{
-				bodyPtr->b2BodyPtr->DestroyFixture(m_radarComponents[entityID].b2FixturePtr);
-				m_radarComponents[entityID].b2FixturePtr = nullptr;
-				CreateRadarFixture(entityID);
-			}
+		case COMPONENT_PHYSICS:
+			m_physicsComponents.Erase(entityID);
+			m_physicsWrapDatas.Erase(entityID);
+			m_lastTransforms.Erase(entityID);
+			m_smoothedTransforms.Erase(entityID);
+			m_lastLinearVelocities.Erase(entityID);
+			m_bodyStates.Erase(entityID);
+			m_spatialGrid.Remove(entityID);
+			break;
+		case COMPONENT_DRAW_ON_RADAR:						m_drawRadarComponents.Erase(entityID); break;
+		case COMPONENT_DRAW_ANIMATION:						m_drawAnimationComponents.Erase(entityID); break;
+		case COMPONENT_DRAW_FIXTURES:						m_drawFixtureComponents.Erase(entityID); break;
+		case COMPONENT_HEALTH:								m_healthComponents.Erase(entityID); break;
+		case COMPONENT_PARENT:								m_parentComponents.Erase(entityID); break;
+		case COMPONENT_PARTICLE_EXPLOSION:					m_particleExplosionComponents.Erase(entityID); break;
+		case COMPONENT_DESTRUCTION_DELAY:					m_destructionDelayComponents.Erase(entityID); break;
+		case COMPONENT_DESTRUCTION_DELAY_ON_CONTACT:		m_destructionDelayOnContactComponents.Erase(entityID); break;
+		case COMPONENT_DESTRUCTION_CHANCE_ON_CONTACT:		m_destructionChanceOnContactComponents.Erase(entityID); break;
+		case COMPONENT_ROTATOR:								m_rotatorComponents.Erase(entityID); break;
+		case COMPONENT_THRUSTER:							m_thrusterComponents.Erase(entityID); break;
+		case COMPONENT_SET_THRUST_AFTER_DELAY:				m_setThrustFactorAfterDelayComponents.Erase(entityID); break;
+		case COMPONENT_BRAKE:								m_brakeComponents.Erase(entityID); break;
+		case COMPONENT_PRIMARY_PROJECTILE_LAUNCHER:			m_primaryProjectileLauncherComponents.Erase(entityID); break;
+		case COMPONENT_SECONDARY_PROJECTILE_LAUNCHER:		m_secondaryProjectileLauncherComponents.Erase(entityID); break;
+		case COMPONENT_FUEL:								m_fuelComponents.Erase(entityID); break;
+		case COMPONENT_BOOSTER:								m_boosterComponents.Erase(entityID); break;
+		case COMPONENT_ICON_COLLECTOR:						m_iconCollectorComponents.Erase(entityID); break;
+		case COMPONENT_POWERUP:								m_powerUpComponents.Erase(entityID); break;
+		case COMPONENT_AI:									m_AIComponents.Erase(entityID); break;
+		case COMPONENT_RADAR:								m_radarComponents.Erase(entityID); break;
+		default: break;
+		}
+	}
+	void World::CancelComponentTimers(EntityID entityID, ComponentBit componentBit)
+	{
+		switch(componentBit)
+		{
+		case COMPONENT_DESTRUCTION_DELAY:			m_timerWheel.Cancel(m_destructionDelayComponents[entityID]); break;
+		case COMPONENT_SET_THRUST_AFTER_DELAY:		m_timerWheel.Cancel(m_setThrustFactorAfterDelayComponents[entityID].timerID); break;
+		case COMPONENT_BOOSTER:						m_timerWheel.Cancel(m_boosterComponents[entityID].timerID); break;
+		case COMPONENT_RADAR:						m_timerWheel.Cancel(m_radarComponents[entityID].refreshTimerID); break;
+		case COMPONENT_PRIMARY_PROJECTILE_LAUNCHER:
+			for(const ProjectileLauncher& launcher : m_primaryProjectileLauncherComponents[entityID].projectileLaunchers)
+				m_timerWheel.Cancel(launcher.readyTimerID);
+			break;
+		case COMPONENT_SECONDARY_PROJECTILE_LAUNCHER:
+			for(const ProjectileLauncher& launcher : m_secondaryProjectileLauncherComponents[entityID].projectileLaunchers)
+				m_timerWheel.Cancel(launcher.readyTimerID);
+			break;
+		default: break;
 		}
 	}
+	//+-----------------------------\-----------------------------
+	//|	  SetComponentTimersPaused	 | (private)
+	//\-----------------------------/
+	//	Countdowns only run while the entity is active. Paused timers
+	//	keep their handles and the steps they have left.
+	//+-------------------------------------------------------------
+	void World::SetComponentTimersPaused(EntityID entityID, bool paused)
+	{
+		auto setPaused = [&](TimerID timerID)
+		{
+			if(paused)
+				m_timerWheel.Pause(timerID);
+			else
+				m_timerWheel.Resume(timerID);
+		};
+		if(HasComponent(entityID, COMPONENT_DESTRUCTION_DELAY))
+			setPaused(m_destructionDelayComponents[entityID]);
+		if(HasComponent(entityID, COMPONENT_SET_THRUST_AFTER_DELAY))
+			setPaused(m_setThrustFactorAfterDelayComponents[entityID].timerID);
+		if(HasComponent(entityID, COMPONENT_BOOSTER))
+			setPaused(m_boosterComponents[entityID].timerID);
+		if(HasComponent(entityID, COMPONENT_RADAR))
+			setPaused(m_radarComponents[entityID].refreshTimerID);
+		if(HasComponent(entityID, COMPONENT_PRIMARY_PROJECTILE_LAUNCHER))
+			for(const ProjectileLauncher& launcher : m_primaryProjectileLauncherComponents[entityID].projectileLaunchers)
+				setPaused(launcher.readyTimerID);
+		if(HasComponent(entityID, COMPONENT_SECONDARY_PROJECTILE_LAUNCHER))
+			for(const ProjectileLauncher& launcher : m_secondaryProjectileLauncherComponents[entityID].projectileLaunchers)
+				setPaused(launcher.readyTimerID);
+	}
+	void World::ClearAllComponentData()
+	{
+		m_healthComponents.Clear();
+		m_destructionDelayComponents.Clear();
+		m_destructionDelayOnContactComponents.Clear();
+		m_destructionChanceOnContactComponents.Clear();
+		m_rotatorComponents.Clear();
+		m_setThrustFactorAfterDelayComponents.Clear();
+		m_thrusterComponents.Clear();
+		m_boosterComponents.Clear();
+		m_fuelComponents.Clear();
+		m_brakeComponents.Clear();
+		m_primaryProjectileLauncherComponents.Clear();
+		m_secondaryProjectileLauncherComponents.Clear();
+		m_parentComponents.Clear();
+
+		m_physicsComponents.Clear();
+		m_physicsWrapDatas.Clear();
+		m_lastTransforms.Clear();
+		m_smoothedTransforms.Clear();
+		m_lastLinearVelocities.Clear();
+		m_bodyStates.Clear();
+		m_projectilePoolIndices.Clear();
+
+		m_particleExplosionComponents.Clear();
+		m_drawAnimationComponents.Clear();
+		m_drawFixtureComponents.Clear();
+		m_drawRadarComponents.Clear();
+		m_powerUpComponents.Clear();
+		m_iconCollectorComponents.Clear();
+		m_AIComponents.Clear();
+		m_radarComponents.Clear();
+	}
+	void World::GrowEntityArrays(EntityID numSlots)
+	{
+		m_entityGenerations.Resize(numSlots);
+		m_liveEntityPositions.Resize(numSlots);
+		m_componentBits.Resize(numSlots);
+		m_flagBits.Resize(numSlots);
+		m_sizeComponents.Resize(numSlots);
+		m_boundingRadiusComponents.Resize(numSlots);
+		m_drawLayers.Resize(numSlots);
+		m_bodyWriteIndices.Resize(numSlots);
+	}
+	// Frees the entity's slot. Component data must already be erased.
+	void World::RetireEntityID(EntityID entityID)
+	{
+		d2Assert(IsValidEntityID(entityID));
+		m_componentBits[entityID].reset();
+		m_flagBits[entityID].reset();
+
+		// Swap the last live entity into the hole
+		size_t position{ m_liveEntityPositions[entityID] };
+		EntityID lastEntityID{ m_liveEntityIDs.back() };
+		m_liveEntityIDs[position] = lastEntityID;
+		m_liveEntityPositions[lastEntityID] = position;
+		m_liveEntityIDs.pop_back();
+
+		// Even generation marks the slot as free and invalidates entityID
+		EntityID index{ GetEntityIndex(entityID) };
+		m_entityGenerations[index] = (m_entityGenerations[index] + 1) & ENTITY_INDEX_MASK;
+		m_freeEntityIndices.push_back(index);
+	}
 }
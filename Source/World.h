@@ -12,14 +12,19 @@
 #include "ParticleSystem.h"
 #include "WorldDef.h"
 #include "WorldUtility.h"
+#include "SparseSet.h"
+#include "SpatialGrid.h"
+#include "BodyStateCache.h"
+#include "SystemScheduler.h"
+#include "ContactEventBuffer.h"
 namespace Space
 {
-	const EntityID WORLD_MAX_ENTITIES = 10000;
 	const float WORLD_CLONE_SYNC_TOLERANCE_FLT_EPSILONS = 4.0f * FLT_EPSILON;
 	const d2d::Color WORLD_DEBUG_DRAW_FIXTURES_COLOR{ d2d::WHITE_OPAQUE };
 	const unsigned WORLD_MAX_ANIMATION_FRAMES = 5;
 	const bool WORLD_IGNORE_CLONE_VS_CLONE_COLLISIONS = false;
 	const float WORLD_BOOST_FUEL_USE_PENALTY_FACTOR = 2.0f;
+	const float WORLD_AI_AVOIDANCE_RADIUS = 20.0f;
 
 	struct InstanceDef
 	{
@@ -60,7 +65,7 @@ namespace Space
 	//+---------------------------------------------\
 	//|  World: b2World wrapper and entity manager  |
 	//\---------------------------------------------/
-	class World : public b2ContactListener, public b2ContactFilter, public b2DestructionListener
+	class World : public b2ContactListener, public b2ContactFilter, public b2DestructionListener, public b2RayCastCallback
 	{
 	public:
 		//+---------------------------------------\
@@ -68,10 +73,14 @@ namespace Space
 		//\---------------------------------------/
 		~World();
 		void Init(const d2d::Rect& rect);
+
+		// Uses settings instead of loading Data/world.hjson, for tools that change them
+		void Init(const d2d::Rect& rect, const WorldDef& settings);
 		void SetDestructionListener(DestroyListener* listenerPtr);
 		void SetWrapListener(WrapListener* listenerPtr);
 		void SetProjectileLauncherListener(ProjectileLauncherListener* listenerPtr);
 		void SetExitListener(ExitListener* listenerPtr);
+		void SetProfiler(Profiler* profilerPtr);
 		void Update(float dt, PlayerController& playerController);
 		void Draw() const;
 
@@ -128,6 +137,8 @@ namespace Space
 			const b2Vec2& localRelativePosition, float impulse, float interval, bool temporarilyDisabled, bool secondaryLaunchers);
 		void RemoveProjectileLauncher(EntityID entityID, unsigned slot, bool secondaryLaunchers);
 		bool IsValidProjectileLauncherSlot(EntityID entityID, unsigned slot, bool secondaryLaunchers) const;
+
+		// Returns INVALID_ENTITY_ID for swept-ray projectiles
 		EntityID LaunchProjectile(const ProjectileDef& projectileDef, const b2Vec2& position,
 			float angle, float impulse, const b2Vec2& parentVelocity, EntityID parentID);
 
@@ -146,15 +157,34 @@ namespace Space
 		// AI
 		void AddAIComponent(EntityID entityID, AIType type);
 		void AddRadarComponent(EntityID entityID, float range);
-		void CreateRadarFixture(EntityID entityID);
-		void MoveRadarToMainBody(EntityID entityID);
 
 		// Query
 		bool IsActive(EntityID entityID) const;
 		const d2d::Rect& GetWorldRect() const;
 		const b2Vec2& GetWorldCenter() const;
 		EntityID GetEntityCount() const;
-
+		ParticleID GetParticleCount() const;
+		unsigned GetUpdateStepCount() const;
+		EntityID GetRecycledEntityCount() const;
+		unsigned GetEmptyPhysicsStepCount() const;
+		unsigned GetCloneBodyCount() const;
+		unsigned GetProjectilePoolHitCount() const;
+		unsigned GetProjectilePoolMissCount() const;
+		float GetRadarRefreshesPerSecond() const;
+		WrapMode GetWrapMode() const;
+
+		// Wall time spent in physics steps, and the number of steps, since the world was created
+		double GetPhysicsStepSeconds() const;
+		unsigned GetPhysicsStepCount() const;
+		unsigned GetContactEventCount(ContactEventType type) const;
+		unsigned GetDroppedContactEventCount() const;
+
+		// Heap allocations made by all threads during update steps. Always 0 unless
+		// IsAllocationCountingEnabled(); a warmed-up level should not allocate at all.
+		unsigned GetLastStepAllocationCount() const;
+		unsigned GetAllocatingStepCount() const;
+
+		bool IsValidEntityID(EntityID entityID) const;
 		bool EntityExists(EntityID entityID) const;
 		bool HasComponent(EntityID entityID, ComponentBit componentBit) const;
 		bool HasComponentSet(EntityID entityID, ComponentBitset componentBits) const;
@@ -165,14 +195,18 @@ namespace Space
 		bool HasSize2D(EntityID entityID) const;
 		bool HasPhysics(EntityID entityID) const;
 
-		// Get <id, boundingCircleGap> of count closest entities
-		std::list<std::pair<EntityID, float>> GetClosestEntities(const b2Vec2& position, 
-			float radius, unsigned count) const;
+		// Get <id, boundingCircleGap> of count closest entities, closest first
+		void GetClosestEntities(const b2Vec2& position, float radius, unsigned count,
+			std::vector<std::pair<EntityID, float>>& closestEntitiesOut) const;
 
 		// Get id of entities whose bounding circle intersects with given area
-		std::vector<EntityID> GetEntitiesInArea(const b2Vec2& position, float radius) const;
+		void GetEntitiesInArea(const b2Vec2& position, float radius, std::vector<EntityID>& entityIDsOut) const;
 
-		RadarComponent GetRadarComponent(EntityID entityID) const;
+		// Batched GetEntitiesInArea. Large batches are spread across the worker threads.
+		void GetEntitiesInAreas(const std::vector<AreaQuery>& queries, AreaQueryResults& resultsOut);
+
+		// Empty if the entity has no radar
+		const std::vector<EntityID>& GetEntitiesInRadarRange(EntityID entityID) const;
 
 		unsigned GetNumFixtures(EntityID entityID) const;
 		int GetDrawLayer(EntityID entityID) const;
@@ -183,30 +217,31 @@ namespace Space
 
 		// Callers of the following must ensure entity has a physics component
 		const b2Transform& GetSmoothedTransform(EntityID entityID) const;
-		const b2Vec2& GetLinearVelocity(EntityID entityID) const;
+		b2Vec2 GetLinearVelocity(EntityID entityID) const;
 		float GetAngularVelocity(EntityID entityID) const;
 		const b2Vec2& GetLocalCenterOfMass(EntityID entityID) const;
-		const b2Vec2& GetWorldCenter(EntityID entityID) const;
+		b2Vec2 GetWorldCenter(EntityID entityID) const;
 
-		// Box2D callbacks
+		// Box2D callbacks. Contacts are only recorded here; ProcessContactEvents acts on them after the step.
 		virtual bool ShouldCollide(b2Fixture* fixturePtr1, b2Fixture* fixturePtr2) override;
 		virtual void BeginContact(b2Contact* contactPtr) override;
-		void BeginContactRadar(b2Fixture* fixturePtr1, b2Fixture* fixturePtr2);
 		virtual void PreSolve(b2Contact* contactPtr, const b2Manifold* oldManifoldPtr) override;
 		void PreSolveExit(b2Fixture* fixturePtr1, b2Fixture* fixturePtr2);
 		void Exit(EntityID id);
 		void PreSolveIconCollector(EntityID id1, EntityID id2, b2Contact* contactPtr);
 		virtual void PostSolve(b2Contact* contactPtr, const b2ContactImpulse* impulsePtr) override;
 		virtual void EndContact(b2Contact* contactPtr) override;
-		void EndContactRadar(b2Fixture* fixturePtr1, b2Fixture* fixturePtr2);
 		virtual void SayGoodbye(b2Joint* joint) override;
 		virtual void SayGoodbye(b2Fixture* fixture) override;
+		virtual float ReportFixture(b2Fixture* fixturePtr, const b2Vec2& point, const b2Vec2& normal, float fraction) override;
 
 		// Health modifiers
 		void AdjustHealth(EntityID entityID, float healthChange);
 		void ReduceHealthToZero(EntityID entityID);
 
-		// Clone-aware modifiers
+		// Clone-aware modifiers. Velocities are set on the main body only and forces and
+		// impulses are buffered until the next physics step; clones pick them up from the
+		// main body when they are synced before the step.
 		void SetTransform(EntityID entityID, const b2Vec2& position, float angle);
 		void SetLinearVelocity(EntityID entityID, const b2Vec2& velocity);
 		void SetAngularVelocity(EntityID entityID, float angularVelocity);
@@ -233,27 +268,53 @@ namespace Space
 		//|          Private Funtions             |
 		//\---------------------------------------/
 		// Updates
+		void AddSystems();
 		void SingleUpdateStep(float dt, PlayerController& playerController);
 		void UpdateEntityCount();
-		void UpdateDestructionDelayComponents(float dt);
+		struct WorldTimer;
+		void UpdateTimers();
+		void TimerExpired(const WorldTimer& timer);
+		TimerID ScheduleTimer(float delay, const WorldTimer& timer);
+		TimerID* GetComponentTimerIDPtr(const WorldTimer& timer);
+		void CancelComponentTimers(EntityID entityID, ComponentBit componentBit);
+		void SetComponentTimersPaused(EntityID entityID, bool paused);
 		void UpdatePlayerControllerComponents(float dt, PlayerController& playerController);
 		void UpdateRotatorComponents();
-		void UpdateSetThrustFactorAfterDelayComponents(float dt);
 		void ApplyThrust(EntityID id, float acceleration);
 		void UpdateThrusterComponents(float dt);
-		void UpdateBoosterComponents(float dt);
 		void UpdateBrakeComponents();
-		void UpdateProjectileLauncherComponents(float dt, bool secondaryLaunchers);
+		void UpdateProjectileLauncherComponents(bool secondaryLaunchers);
+		void LaunchRayProjectile(const ProjectileDef& projectileDef, const b2Vec2& position,
+			float angle, float impulse, const b2Vec2& parentVelocity, EntityID parentID);
+		struct RayProjectile;
+		void UpdateRayProjectiles(float dt);
+		bool EntityContainsPoint(EntityID entityID, const b2Vec2& point) const;
+		void RayProjectileHit(const RayProjectile& ray);
 		void UpdateDrawAnimationComponents(float dt);
 		void UpdateAIComponents(float dt);
-		void ApplyImpulseDamage(Body* bodyPtr1, Body* bodyPtr2, const float* normalImpulses, unsigned numImpulses);
+		void RefreshRadar(EntityID entityID);
+		void ProcessContactEvents();
+		void ProcessContactEventsAndDestroyBuffer();
+		void CollectIcon(EntityID collectorID, EntityID iconID);
+		void ApplyImpulseDamage(const ContactEvent& event);
+		void LogImpulseDamage(const ContactEvent& event, float totalDamage) const;
+		void ApplyContactEnd(const ContactEvent& event);
 
 		// Physics
 		void UpdatePhysics(float dt);
+		void AttachMainBody(EntityID entityID, b2Body* b2BodyPtr);
+		size_t GetProjectilePoolIndex(const ProjectileDef& projectileDef);
+		bool TakePooledProjectileBody(EntityID entityID, const ProjectileDef& projectileDef, const InstanceDef& def);
+		void ReturnProjectileBody(EntityID entityID);
+		size_t GetBodyWriteIndex(EntityID entityID);
+		void FlushBodyWrites();
 		void SaveVelocities();
 		void EmptyPhysicsStep();
 		void ResetSmoothStates();
 		void SyncClones();
+		bool NeedsCloneBody(CloneSection cloneSection, const b2Vec2& position, float boundingRadius, float margin) const;
+		void CreateCloneBody(EntityID entityID, CloneBody& cloneBody, const b2Vec2& position);
+		void DestroyCloneBody(CloneBody& cloneBody);
 		bool NeedsSync(float actualValue, float perfectValue) const;
 		bool NeedsSync(const b2Vec2& actualValue, const b2Vec2& perfectValue) const;
 		Quadrant GetQuadrant(const b2Vec2& position) const;
@@ -263,14 +324,29 @@ namespace Space
 		bool GetCloneSectionFromWrapData(const PhysicsWrapData& wrapData, CloneSection& cloneSectionOut) const;
 		CloneSection GetOpposingCloneSection(CloneSection cloneSection) const;
 		void WrapEntities();
+		void TeleportEntities();
+		void SetCrossedBounds(PhysicsWrapData& wrapData, const b2Vec2& position) const;
+		b2Vec2 GetWrapTranslation(const PhysicsWrapData& wrapData) const;
 		void SwitchB2Bodies(Body& body1, Body& body2);
 		void SmoothStates(float timestepAlpha);
+		void UpdateSpatialGrid();
 		void ProcessDestroyBuffer();
 		bool ShouldCollideDefaultFiltering(const b2Filter& filter1, const b2Filter& filter2) const;
 		void CreateExplosionFromEntity(EntityID entityID, const ParticleExplosionComponent& particleExplosion);
 
+		// Entity index
+		void SetComponentBit(EntityID entityID, ComponentBit componentBit);
+		void ResetComponentBit(EntityID entityID, ComponentBit componentBit);
+		void ResetComponentBits(EntityID entityID, ComponentBitset componentBits);
+		void EraseComponentData(EntityID entityID, ComponentBit componentBit);
+		void ClearAllComponentData();
+		void LogLevelB2MemoryStats() const;
+		void GrowEntityArrays(EntityID numSlots);
+		void RetireEntityID(EntityID entityID);
+
 		// Box2D user data
-		Body* GetUserBodyPtr(b2Body* b2BodyPtr) const;
+		Body* GetUserBodyPtr(b2Body* b2BodyPtr);
+		const Body* GetUserBodyPtr(b2Body* b2BodyPtr) const;
 		Body* GetUserBodyFromFixture(b2Fixture* fixturePtr);
 		void SetB2BodyPtr(Body* bodyPtr, b2Body* b2BodyPtr);
 		void SwapB2Bodies(Body& body1, Body& body2);
@@ -283,6 +359,7 @@ namespace Space
 		void DrawThrusterComponent(const ThrusterComponent& thrusterComponent, const b2Vec2& entitySize,
 			const b2Vec2& position, float angle) const;
 		void DrawAllAnimationComponents(int layer) const;
+		void DrawAllRayProjectiles(int layer) const;
 		void DrawAnimation(const d2d::Animation& animation, const b2Vec2& size, const b2Vec2& position, float angle) const;
 		void DrawAllFixturesComponents(int layer) const;
 		void DrawFixtureList(b2Fixture* fixturePtr, const b2Vec2& position, float angle, bool fill) const;
@@ -307,67 +384,216 @@ namespace Space
 			EntityID entityID;
 			b2Vec2 position;
 		};
+		enum class WorldTimerType
+		{
+			DESTRUCTION_DELAY,
+			SET_THRUST_FACTOR,
+			BOOST_END,
+			BOOST_COOLDOWN_END,
+			PRIMARY_LAUNCHER_READY,
+			SECONDARY_LAUNCHER_READY,
+			RADAR_REFRESH
+		};
+		struct WorldTimer
+		{
+			WorldTimerType type{};
+			EntityID entityID{};
+			unsigned slot{};
+		};
+		struct ProjectilePool
+		{
+			std::string modelName;
+			b2Vec2 dimensions;
+			bool fixedRotation;
+			bool continuousCollisionDetection;
+			d2d::Material material;
+			d2d::Filter filter;
+			std::vector<b2Body*> b2BodyPtrs;
+
+			// Taken from a temporary body the first time a swept-ray projectile is launched
+			bool hasRayData{ false };
+			float rayMass{};
+			b2Filter rayFilter;
+		};
+		struct RayProjectile
+		{
+			size_t poolIndex;
+			EntityID parentID;
+			b2Vec2 size;
+			int drawLayer;
+			b2Vec2 position;
+			b2Vec2 lastPosition;
+			b2Vec2 smoothedPosition;
+			b2Vec2 velocity;
+			float angle;
+			float acceleration;
+			float accelerationSecondsLeft;
+			float secondsLeft;
+			bool ignoreParent;
+			bool touchingParent;
+			d2d::Animation animation;
+		};
+		// Per-entity storage addressed by the slot index of an EntityID
 		template<class T> class ComponentArray
-			: public std::array<T, WORLD_MAX_ENTITIES>{};
-		typedef std::array<CloneSyncData, WORLD_NUM_CLONES> CloneSyncDataArray;
+		{
+		public:
+			typename std::vector<T>::reference operator[](EntityID entityID)
+			{
+				d2Assert(GetEntityIndex(entityID) < m_data.size());
+				return m_data[GetEntityIndex(entityID)];
+			}
+			typename std::vector<T>::const_reference operator[](EntityID entityID) const
+			{
+				d2Assert(GetEntityIndex(entityID) < m_data.size());
+				return m_data[GetEntityIndex(entityID)];
+			}
+			void Resize(EntityID numSlots) { m_data.resize(numSlots); }
+			EntityID Size() const { return m_data.size(); }
+			void Clear() { m_data.clear(); }
+		private:
+			std::vector<T> m_data;
+		};
 
 		//+---------------------------------------\
 		//|			    Private Data	          |
 		//\---------------------------------------/
 		WorldDef m_settings;
 		EntityID m_highestActiveEntityCount{ 0 };
+		EntityID m_recycledEntityCount{ 0 };
 		DestroyListener* m_destructionListenerPtr{ nullptr };
 		WrapListener* m_wrappedEntityListenerPtr{ nullptr };
 		ProjectileLauncherListener* m_projectileLauncherListenerPtr{ nullptr };
 		ExitListener* m_exitListenerPtr{ nullptr };
 
 		float m_timestepAccumulator{ 0.0f };
+		double m_physicsStepSeconds{ 0.0 };
+		unsigned m_physicsStepCount{ 0 };
+		unsigned m_emptyPhysicsStepCount{ 0 };
+		unsigned m_cloneBodyCount{ 0 };
+		unsigned m_highestCloneBodyCount{ 0 };
+		unsigned m_updateStepCount{ 0 };
+		unsigned m_allocatingStepCount{ 0 };
+		unsigned m_lastStepAllocationCount{ 0 };
+
+		// Phases timed when a profiler is set. Systems are timed by m_systemScheduler.
+		Profiler* m_profilerPtr{ nullptr };
+		struct
+		{
+			ProfilerPhaseID updateStep{ INVALID_PROFILER_PHASE_ID };
+			ProfilerPhaseID destroyBuffer{ INVALID_PROFILER_PHASE_ID };
+			ProfilerPhaseID bodyWrites{ INVALID_PROFILER_PHASE_ID };
+			ProfilerPhaseID saveStates{ INVALID_PROFILER_PHASE_ID };
+			ProfilerPhaseID syncClones{ INVALID_PROFILER_PHASE_ID };
+			ProfilerPhaseID b2WorldStep{ INVALID_PROFILER_PHASE_ID };
+			ProfilerPhaseID bodyStates{ INVALID_PROFILER_PHASE_ID };
+			ProfilerPhaseID contactEvents{ INVALID_PROFILER_PHASE_ID };
+			ProfilerPhaseID wrap{ INVALID_PROFILER_PHASE_ID };
+			ProfilerPhaseID spatialGrid{ INVALID_PROFILER_PHASE_ID };
+			ProfilerPhaseID draw{ INVALID_PROFILER_PHASE_ID };
+		} m_profilerPhases;
+
+		// Systems run by SingleUpdateStep and the arguments of the current step
+		SystemScheduler m_systemScheduler;
+		float m_stepTime{ 0.0f };
+		PlayerController* m_stepPlayerControllerPtr{ nullptr };
 		b2World* m_b2WorldPtr{ nullptr };
-		std::set< EntityID > m_destroyBuffer;
+		std::vector< EntityID > m_destroyBuffer;
+		ContactEventBuffer m_contactEvents;
+
+		// Countdowns of components, in physics steps. Each one is scheduled once
+		// and handled by TimerExpired when it comes due.
+		TimerWheel< WorldTimer > m_timerWheel;
 		std::list< DamageData > m_damageDataList;
 		b2Vec2 m_worldDimensions;
 		b2Vec2 m_worldCenter;
 		d2d::Rect m_worldRect;
 
+		// Packed list of live entities (unordered)
+		std::vector<EntityID> m_liveEntityIDs;
+
+		// Slots freed by ProcessDestroyBuffer, reused last in first out
+		std::vector<EntityID> m_freeEntityIndices;
+
+		// Current generation of every slot (odd while in use) and,
+		// for slots in use, the entity's position in m_liveEntityIDs
+		ComponentArray< EntityID > m_entityGenerations;
+		ComponentArray< size_t > m_liveEntityPositions;
+
 		// All entities have these by default:
 		ComponentArray< ComponentBitset > m_componentBits;
 		ComponentArray< FlagBitset > m_flagBits;
-		ComponentArray< bool > m_activeFlags;
 		ComponentArray< b2Vec2 > m_sizeComponents;
 		ComponentArray< float > m_boundingRadiusComponents;
+		ComponentArray< int > m_drawLayers;
+
+		// Forces and impulses from the clone-aware modifiers, one entry per entity,
+		// applied to main bodies by FlushBodyWrites
+		ComponentArray< size_t > m_bodyWriteIndices;
+		std::vector< EntityID > m_bodyWriteEntityIDs;
+		std::vector< float > m_bodyWriteForcesX;
+		std::vector< float > m_bodyWriteForcesY;
+		std::vector< float > m_bodyWriteTorques;
+		std::vector< float > m_bodyWriteImpulsesX;
+		std::vector< float > m_bodyWriteImpulsesY;
+		std::vector< float > m_bodyWriteAngularImpulses;
 
 		// These must be manually added after calling NewEntityID()
-		//ComponentArray< int > m_levelTagComponents;
-		ComponentArray< HealthComponent > m_healthComponents;
-		ComponentArray< float > m_destructionDelayComponents;
-		ComponentArray< float > m_destructionDelayOnContactComponents;
-		ComponentArray< float > m_destructionChanceOnContactComponents;
-		ComponentArray< RotatorComponent > m_rotatorComponents;
-		ComponentArray< SetThrustFactorAfterDelayComponent > m_setThrustFactorAfterDelayComponents;
-		ComponentArray< ThrusterComponent > m_thrusterComponents;
-		ComponentArray< BoosterComponent > m_boosterComponents;
-		ComponentArray< FuelComponent > m_fuelComponents;
-		ComponentArray< BrakeComponent > m_brakeComponents;
-		ComponentArray< ProjectileLauncherComponent > m_primaryProjectileLauncherComponents;
-		ComponentArray< ProjectileLauncherComponent > m_secondaryProjectileLauncherComponents;
-		ComponentArray< EntityID > m_parentComponents;
-
-		ComponentArray< PhysicsComponent > m_physicsComponents;
-		ComponentArray< PhysicsWrapData > m_physicsWrapDatas;
-		ComponentArray< b2Transform > m_lastTransforms;
-		ComponentArray< b2Transform > m_smoothedTransforms;
-		ComponentArray< b2Vec2 > m_lastLinearVelocities;
-		ComponentArray< CloneSyncDataArray > m_cloneSyncDataArrays;
+		// Each is stored only for the entities that own it (see SparseSet.h)
+		//SparseSet< int > m_levelTagComponents;
+		SparseSet< HealthComponent > m_healthComponents;
+		SparseSet< TimerID > m_destructionDelayComponents;
+		SparseSet< float > m_destructionDelayOnContactComponents;
+		SparseSet< float > m_destructionChanceOnContactComponents;
+		SparseSet< RotatorComponent > m_rotatorComponents;
+		SparseSet< SetThrustFactorAfterDelayComponent > m_setThrustFactorAfterDelayComponents;
+		SparseSet< ThrusterComponent > m_thrusterComponents;
+		SparseSet< BoosterComponent > m_boosterComponents;
+		SparseSet< FuelComponent > m_fuelComponents;
+		SparseSet< BrakeComponent > m_brakeComponents;
+		SparseSet< ProjectileLauncherComponent > m_primaryProjectileLauncherComponents;
+		SparseSet< ProjectileLauncherComponent > m_secondaryProjectileLauncherComponents;
+		SparseSet< EntityID > m_parentComponents;
+
+		// Physics state, added and removed together with COMPONENT_PHYSICS
+		SparseSet< PhysicsComponent > m_physicsComponents;
+		SparseSet< PhysicsWrapData > m_physicsWrapDatas;
+		SparseSet< b2Transform > m_lastTransforms;
+		SparseSet< b2Transform > m_smoothedTransforms;
+		SparseSet< b2Vec2 > m_lastLinearVelocities;
+		BodyStateCache m_bodyStates;
+		std::vector< EntityID > m_wrapCandidateIDs;
+
+		// Disabled main bodies of destroyed projectiles, with their fixtures, kept
+		// for reuse by LaunchProjectile. Projectiles that came from a pool carry
+		// its index so DestroyB2Bodies can give the body back.
+		std::vector< ProjectilePool > m_projectilePools;
+		SparseSet< size_t > m_projectilePoolIndices;
+		unsigned m_projectilePoolHitCount{ 0 };
+		unsigned m_projectilePoolMissCount{ 0 };
+
+		// Swept-ray projectiles (unordered) and the state of the ray cast in progress
+		std::vector< RayProjectile > m_rayProjectiles;
+		size_t m_rayCastIndex{ 0 };
+		b2Fixture* m_rayHitFixturePtr{ nullptr };
+		b2Vec2 m_rayHitPoint;
+		b2Vec2 m_rayHitNormal;
+		bool m_rayTouchedParent{ false };
+		SpatialGrid m_spatialGrid;
 
 		ParticleSystem m_particleSystem;
-		ComponentArray< ParticleExplosionComponent > m_particleExplosionComponents;
-		ComponentArray< DrawAnimationComponent > m_drawAnimationComponents;
-		ComponentArray< DrawFixturesComponent > m_drawFixtureComponents;
-		ComponentArray< DrawRadarComponent > m_drawRadarComponents;
-		ComponentArray< PowerUpComponent > m_powerUpComponents;
-		ComponentArray< IconCollectorComponent > m_iconCollectorComponents;
-		ComponentArray< AIComponent > m_AIComponents;
-		ComponentArray< RadarComponent > m_radarComponents;
+		SparseSet< ParticleExplosionComponent > m_particleExplosionComponents;
+		SparseSet< DrawAnimationComponent > m_drawAnimationComponents;
+		SparseSet< DrawFixturesComponent > m_drawFixtureComponents;
+		SparseSet< DrawRadarComponent > m_drawRadarComponents;
+		SparseSet< PowerUpComponent > m_powerUpComponents;
+		SparseSet< IconCollectorComponent > m_iconCollectorComponents;
+		SparseSet< AIComponent > m_AIComponents;
+		std::vector< AreaQuery > m_AIAreaQueries;
+		std::vector< EntityID > m_AIAreaQueryEntityIDs;
+		AreaQueryResults m_AIAreaQueryResults;
+		SparseSet< RadarComponent > m_radarComponents;
+		std::vector< EntityID > m_emptyRadarEntityIDs;
+		unsigned m_radarRefreshCount{ 0 };
 
 		d2d::ShapeFactory m_shapeFactory;
 	};
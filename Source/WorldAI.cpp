@@ -17,9 +17,9 @@ namespace Space
 	//\----------------------/------------------------------------
 	void World::AddAIComponent(EntityID entityID, AIType type)
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		m_componentBits[entityID].set(COMPONENT_AI);
-		m_AIComponents[entityID].type = type;
+		d2Assert(IsValidEntityID(entityID));
+		SetComponentBit(entityID, COMPONENT_AI);
+		m_AIComponents.Insert(entityID).type = type;
 	}
 
 	//+----------------------\------------------------------------
@@ -27,19 +27,48 @@ namespace Space
 	//\----------------------/------------------------------------
 	void World::UpdateAIComponents(float dt)
 	{
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(HasComponentSet(id, COMPONENT_AI) && IsActive(id))
-			{
+		// Find what is near every roaming entity in one batch
+		m_AIAreaQueries.clear();
+		m_AIAreaQueryEntityIDs.clear();
+		for(EntityID id : m_AIComponents.GetEntityIDs())
+			if(HasPhysics(id) && IsActive(id))
 				if(m_AIComponents[id].type == AIType::AI_ROAM)
 				{
-					// Turn to avoid collision
-					for(EntityID id : GetEntitiesInArea(m_smoothedTransforms[id].p, 20.0f))
-					{
-						
-					}
-
-					// Thrust until ideal speed
+					m_AIAreaQueries.push_back({ m_smoothedTransforms[id].p, WORLD_AI_AVOIDANCE_RADIUS });
+					m_AIAreaQueryEntityIDs.push_back(id);
 				}
+		GetEntitiesInAreas(m_AIAreaQueries, m_AIAreaQueryResults);
+
+		for(size_t i = 0; i < m_AIAreaQueryEntityIDs.size(); ++i)
+		{
+			EntityID id{ m_AIAreaQueryEntityIDs[i] };
+
+			// Turn to avoid collision
+			for(EntityID nearbyID : m_AIAreaQueryResults[i])
+			{
+
 			}
+
+			// Thrust until ideal speed
+		}
+	}
+	//+----------------------\------------------------------------
+	//|	     RefreshRadar	 |
+	//\----------------------/------------------------------------
+	// Runs on the radar's timer. The spatial grid wraps around the world
+	// edges, so entities across the edge are seen as they were with clones.
+	void World::RefreshRadar(EntityID entityID)
+	{
+		++m_radarRefreshCount;
+		RadarComponent& radar{ m_radarComponents[entityID] };
+		radar.entitiesInRange.clear();
+		if(!HasPhysics(entityID))
+			return;
+
+		m_spatialGrid.QueryRadius(m_bodyStates.GetPosition(entityID), radar.range, radar.entitiesInRange);
+		std::sort(radar.entitiesInRange.begin(), radar.entitiesInRange.end());
+		auto ownerIt{ std::lower_bound(radar.entitiesInRange.begin(), radar.entitiesInRange.end(), entityID) };
+		if(ownerIt != radar.entitiesInRange.end() && *ownerIt == entityID)
+			radar.entitiesInRange.erase(ownerIt);
 	}
 }
\ No newline at end of file
@@ -29,10 +29,16 @@ namespace Space
 			debugDrawFixtures = d2d::GetBool(data, "debugDrawFixtures");
 			drawLayerRange.Set(d2d::GetVectorInt(data, "drawLayerRange", 0),
 				d2d::GetVectorInt(data, "drawLayerRange", 1));
+			cloneMargin = d2d::GetFloat(data, "cloneMargin");
+			spatialGridCellSize = d2d::GetFloat(data, "spatialGridCellSize");
+			radarRefreshesPerSecond = d2d::GetFloat(data, "radarRefreshesPerSecond");
+			workerThreads = d2d::GetInt(data, "workerThreads");
 			stepsPerSecond = d2d::GetFloat(data, "stepsPerSecond");
 			maxUpdateTime = d2d::GetFloat(data, "maxUpdateTime");
 			velocityIterationsPerStep = d2d::GetInt(data, "velocityIterationsPerStep");
 			positionIterationsPerStep = d2d::GetInt(data, "positionIterationsPerStep");
+			contactEventCapacity = d2d::GetInt(data, "contactEventCapacity");
+			rayProjectileCapacity = d2d::GetInt(data, "rayProjectileCapacity");
 			damageToImpulseRatio = d2d::GetFloat(data, "damageToImpulseRatio");
 			minTotalCollisionDamage = d2d::GetFloat(data, "minTotalCollisionDamage");
 			damageLogging = d2d::GetBool(data, "damageLogging");
@@ -71,10 +77,16 @@ namespace Space
 	{
 		if(shapeFilePath.empty()) throw SettingOutOfRangeException{ "shapeFilePath" };
 		if(drawFixturesLineWidth <= 0.0f) throw SettingOutOfRangeException{ "drawFixturesLineWidth" };
+		if(cloneMargin < 0.0f) throw SettingOutOfRangeException{ "cloneMargin" };
+		if(spatialGridCellSize <= 0.0f) throw SettingOutOfRangeException{ "spatialGridCellSize" };
+		if(radarRefreshesPerSecond <= 0.0f) throw SettingOutOfRangeException{ "radarRefreshesPerSecond" };
+		if(workerThreads < 0) throw SettingOutOfRangeException{ "workerThreads" };
 		if(stepsPerSecond <= 0.0f) throw SettingOutOfRangeException{ "stepsPerSecond" };
 		if(maxUpdateTime <= 0.0f) throw SettingOutOfRangeException{ "maxUpdateTime" };
 		if(velocityIterationsPerStep <= 0) throw SettingOutOfRangeException{ "velocityIterationsPerStep" };
 		if(positionIterationsPerStep <= 0) throw SettingOutOfRangeException{ "positionIterationsPerStep" };
+		if(contactEventCapacity <= 0) throw SettingOutOfRangeException{ "contactEventCapacity" };
+		if(rayProjectileCapacity <= 0) throw SettingOutOfRangeException{ "rayProjectileCapacity" };
 
 		// healthMeter
 		if(healthMeter.gap < 0.0f) throw SettingOutOfRangeException{ "healthMeter.gap" };
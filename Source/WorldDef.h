@@ -22,6 +22,13 @@ namespace Space
 		d2d::Color damagedColor;
 		d2d::Color badlyDamagedColor;
 	};
+	// How entities crossing the world edge are handled
+	//	CLONES: bodies within cloneMargin of the world edge get up to WORLD_NUM_CLONES
+	//		clone bodies offset by the world size, so collisions work across the edge
+	//	TELEPORT: one body per entity, moved to the opposite edge after crossing;
+	//		there are no collisions across the edge, so it changes gameplay. Only
+	//		space_bench uses it, to measure what the clone bodies cost.
+	enum class WrapMode { CLONES, TELEPORT };
 	struct WorldDef
 	{
 		void LoadFrom(const std::string& worldFilePath);
@@ -31,10 +38,17 @@ namespace Space
 		float drawFixturesLineWidth;
 		bool debugDrawFixtures;
 		d2d::Range<int> drawLayerRange;
+		WrapMode wrapMode{ WrapMode::CLONES };	// not in world.hjson
+		float cloneMargin;
+		float spatialGridCellSize;
+		float radarRefreshesPerSecond;
+		int workerThreads;
 		float stepsPerSecond;
 		float maxUpdateTime;
 		int velocityIterationsPerStep;
 		int positionIterationsPerStep;
+		int contactEventCapacity;
+		int rayProjectileCapacity;
 		float damageToImpulseRatio;
 		float minTotalCollisionDamage;
 		bool damageLogging;
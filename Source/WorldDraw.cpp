@@ -15,6 +15,7 @@ namespace Space
 {
 	void World::Draw() const
 	{
+		ScopedTimer timer{ m_profilerPtr, m_profilerPhases.draw };
 		DrawWorldEdge();
 		for(int i = m_settings.drawLayerRange.GetMin(); i <= m_settings.drawLayerRange.GetMax(); ++i)
 			DrawLayer(i);
@@ -40,9 +41,11 @@ namespace Space
 	}
 	void World::DrawLayer(int layer) const
 	{
+		TraceScope trace{ "World::DrawLayer", "layer", layer };
 		DrawParticleSystem(layer);
 		DrawAllThrusterComponents(layer);
 		DrawAllAnimationComponents(layer);
+		DrawAllRayProjectiles(layer);
 		DrawAllFixturesComponents(layer);
 	}
 	void World::DrawParticleSystem(int layer) const
@@ -53,7 +56,7 @@ namespace Space
 		for(unsigned sizeIndex = 0; sizeIndex < d2d::Window::NUM_POINT_SIZES; ++sizeIndex)
 		{
 			d2d::Window::SetPointSize(d2d::Window::POINT_SIZES[sizeIndex]);
-			for(ParticleID i = 0; i < m_particleSystem.firstUnusedIndex; ++i)
+			for(ParticleID i = 0; i < m_particleSystem.GetParticleCount(); ++i)
 				if(m_particleSystem.layers[i] == layer)
 					if(m_particleSystem.pointSizeIndices[i] == sizeIndex)
 					{
@@ -61,10 +64,11 @@ namespace Space
 						newColor.alpha = m_particleSystem.CalculateFadedAlpha(i);
 						d2d::Window::SetColor(newColor);
 
-						d2d::Window::DrawPoint(m_particleSystem.smoothedPositions[i]);
-						CloneSectionList cloneLocations{ GetCloneSectionList(m_particleSystem.smoothedPositions[i]) };
+						b2Vec2 position{ m_particleSystem.GetSmoothedPosition(i) };
+						d2d::Window::DrawPoint(position);
+						CloneSectionList cloneLocations{ GetCloneSectionList(position) };
 						for(auto &cloneLocation : cloneLocations)
-							d2d::Window::DrawPoint(m_particleSystem.smoothedPositions[i] + GetCloneOffset(cloneLocation));
+							d2d::Window::DrawPoint(position + GetCloneOffset(cloneLocation));
 					}
 		}
 	}
@@ -74,8 +78,8 @@ namespace Space
 		d2d::Window::EnableBlending();
 		ComponentBitset requiredComponents; 
 		requiredComponents.set(COMPONENT_THRUSTER).set(COMPONENT_PHYSICS);
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(m_drawAnimationComponents[id].layer == layer)
+		for(EntityID id : m_thrusterComponents.GetEntityIDs())
+			if(m_drawLayers[id] == layer)
 				if(HasComponentSet(id, requiredComponents) && HasSize2D(id) && IsActive(id))
 					if(m_thrusterComponents[id].factor > 0.0f)
 					{
@@ -89,7 +93,7 @@ namespace Space
 							b2Vec2 size = m_sizeComponents[id];
 							bool boost = false;
 							if(HasComponent(id, COMPONENT_BOOSTER) &&
-								m_boosterComponents[id].secondsLeft > 0.0f)
+								m_boosterComponents[id].boosting)
 							{
 								boost = true;
 							}
@@ -122,11 +126,11 @@ namespace Space
 		d2d::Window::EnableBlending();
 		ComponentBitset requiredComponents;
 		requiredComponents.set(COMPONENT_DRAW_ANIMATION).set(COMPONENT_PHYSICS);
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(m_drawAnimationComponents[id].layer == layer)
+		for(EntityID id : m_drawAnimationComponents.GetEntityIDs())
+			if(m_drawLayers[id] == layer)
 				if(HasComponentSet(id, requiredComponents) && HasSize2D(id) && IsActive(id))
 				{
-					float angle{ m_physicsComponents[id].mainBody.b2BodyPtr->GetAngle() };
+					float angle{ m_bodyStates.GetAngle(id) };
 
 					// Main entity
 					DrawAnimation(m_drawAnimationComponents[id].animation, m_sizeComponents[id], m_smoothedTransforms[id].p, angle);
@@ -136,6 +140,14 @@ namespace Space
 						DrawAnimation(m_drawAnimationComponents[id].animation, m_sizeComponents[id], m_smoothedTransforms[id].p + GetCloneOffset(cloneBody.section), angle);
 				}
 	}
+	void World::DrawAllRayProjectiles(int layer) const
+	{
+		d2d::Window::EnableTextures();
+		d2d::Window::EnableBlending();
+		for(const RayProjectile& ray : m_rayProjectiles)
+			if(ray.drawLayer == layer)
+				DrawAnimation(ray.animation, ray.size, ray.smoothedPosition, ray.angle);
+	}
 	void World::DrawAnimation(const d2d::Animation& animation, const b2Vec2& size, const b2Vec2& position, float angle) const
 	{
 		d2d::Window::PushMatrix();
@@ -149,8 +161,8 @@ namespace Space
 		d2d::Window::DisableTextures();
 		d2d::Window::EnableBlending();
 		d2d::Window::SetLineWidth(m_settings.drawFixturesLineWidth);
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(m_drawAnimationComponents[id].layer == layer)
+		for(EntityID id : m_physicsComponents.GetEntityIDs())
+			if(m_drawLayers[id] == layer)
 			{
 				bool draw{ false };
 				if(HasPhysics(id) && IsActive(id))
@@ -169,10 +181,11 @@ namespace Space
 				if(draw)
 				{
 					float angle{ m_smoothedTransforms[id].q.GetAngle() };
-					DrawFixtureList(m_physicsComponents[id].mainBody.b2BodyPtr->GetFixtureList(), m_smoothedTransforms[id].p, angle, m_drawFixtureComponents[id].fill);
+					bool fill{ HasComponent(id, COMPONENT_DRAW_FIXTURES) && m_drawFixtureComponents[id].fill };
+					DrawFixtureList(m_physicsComponents[id].mainBody.b2BodyPtr->GetFixtureList(), m_smoothedTransforms[id].p, angle, fill);
 					for(const CloneBody& cloneBody : m_physicsComponents[id].cloneBodyList)
-						DrawFixtureList(cloneBody.b2BodyPtr->GetFixtureList(),
-							m_smoothedTransforms[id].p + GetCloneOffset(cloneBody.section), angle, m_drawFixtureComponents[id].fill);
+						DrawFixtureList(m_physicsComponents[id].mainBody.b2BodyPtr->GetFixtureList(),
+							m_smoothedTransforms[id].p + GetCloneOffset(cloneBody.section), angle, fill);
 				}
 			}
 	}
@@ -217,7 +230,7 @@ namespace Space
 		d2d::Window::EnableBlending();
 		ComponentBitset requiredComponents;
 		requiredComponents.set(COMPONENT_HEALTH).set(COMPONENT_PHYSICS);
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
+		for(EntityID id : m_healthComponents.GetEntityIDs())
 			if(HasComponentSet(id, requiredComponents) && IsActive(id))
 				if(m_healthComponents[id].hp < m_healthComponents[id].hpMax)
 				{
@@ -31,51 +31,172 @@ namespace Space
 	//\----------------------/------------------------------------
 	EntityID World::GetEntityCount() const
 	{
-		EntityID entityCount{ 0 };
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(EntityExists(id))
-				++entityCount;
-		return entityCount;
+		return m_liveEntityIDs.size();
+	}
+	//+----------------------\------------------------------------
+	//|	  GetParticleCount	 |
+	//\----------------------/------------------------------------
+	ParticleID World::GetParticleCount() const
+	{
+		return m_particleSystem.GetParticleCount();
+	}
+	//+----------------------\------------------------------------
+	//|	 GetUpdateStepCount	 |
+	//\----------------------/------------------------------------
+	// Number of fixed steps taken by Update since the World was created
+	unsigned World::GetUpdateStepCount() const
+	{
+		return m_updateStepCount;
+	}
+	//+------------------------------\----------------------------
+	//|	   GetRecycledEntityCount	 |
+	//\------------------------------/----------------------------
+	// Number of entities created in a slot freed by an earlier entity
+	EntityID World::GetRecycledEntityCount() const
+	{
+		return m_recycledEntityCount;
+	}
+	//+------------------------------\----------------------------
+	//|	  GetEmptyPhysicsStepCount	 |
+	//\------------------------------/----------------------------
+	// Number of zero-dt Box2D steps taken during the last Update
+	unsigned World::GetEmptyPhysicsStepCount() const
+	{
+		return m_emptyPhysicsStepCount;
+	}
+	//+------------------------------\----------------------------
+	//|	     GetCloneBodyCount		 |
+	//\------------------------------/----------------------------
+	// Number of clone b2Bodies that currently exist (always 0 when teleport wrapping)
+	unsigned World::GetCloneBodyCount() const
+	{
+		return m_cloneBodyCount;
+	}
+	//+------------------------------\----------------------------
+	//|	  GetProjectilePoolHitCount	 |
+	//\------------------------------/----------------------------
+	// Number of projectiles launched with a reused body
+	unsigned World::GetProjectilePoolHitCount() const
+	{
+		return m_projectilePoolHitCount;
+	}
+	//+------------------------------\----------------------------
+	//|	 GetProjectilePoolMissCount	 |
+	//\------------------------------/----------------------------
+	// Number of projectiles launched with a newly created body
+	unsigned World::GetProjectilePoolMissCount() const
+	{
+		return m_projectilePoolMissCount;
+	}
+	//+------------------------------\----------------------------
+	//|	  GetRadarRefreshesPerSecond |
+	//\------------------------------/----------------------------
+	// Radar queries per second of simulated time, averaged over all physics steps so far
+	float World::GetRadarRefreshesPerSecond() const
+	{
+		if(m_physicsStepCount == 0)
+			return 0.0f;
+		return m_radarRefreshCount * m_settings.stepsPerSecond / m_physicsStepCount;
+	}
+	//+------------------------------\----------------------------
+	//|		   GetWrapMode			 |
+	//\------------------------------/----------------------------
+	WrapMode World::GetWrapMode() const
+	{
+		return m_settings.wrapMode;
+	}
+	//+------------------------------\----------------------------
+	//|	    GetPhysicsStepSeconds	 |
+	//\------------------------------/----------------------------
+	// Compare between wrap modes; space_bench reports it per scenario
+	double World::GetPhysicsStepSeconds() const
+	{
+		return m_physicsStepSeconds;
+	}
+	//+------------------------------\----------------------------
+	//|	    GetPhysicsStepCount		 |
+	//\------------------------------/----------------------------
+	unsigned World::GetPhysicsStepCount() const
+	{
+		return m_physicsStepCount;
+	}
+	//+------------------------------\----------------------------
+	//|	  GetContactEventCount		 |
+	//\------------------------------/----------------------------
+	// Contact events of the type recorded during the last physics step
+	unsigned World::GetContactEventCount(ContactEventType type) const
+	{
+		return m_contactEvents.GetCount(type);
+	}
+	//+------------------------------\----------------------------
+	//|	 GetDroppedContactEventCount |
+	//\------------------------------/----------------------------
+	// Contact events lost during the last physics step because the buffer was full
+	unsigned World::GetDroppedContactEventCount() const
+	{
+		return m_contactEvents.GetDroppedCount();
+	}
+	//+------------------------------\----------------------------
+	//|	 GetLastStepAllocationCount	 |
+	//\------------------------------/----------------------------
+	unsigned World::GetLastStepAllocationCount() const
+	{
+		return m_lastStepAllocationCount;
+	}
+	//+------------------------------\----------------------------
+	//|	   GetAllocatingStepCount	 |
+	//\------------------------------/----------------------------
+	// Number of update steps so far that allocated at least once
+	unsigned World::GetAllocatingStepCount() const
+	{
+		return m_allocatingStepCount;
+	}
+	//+----------------------\------------------------------------
+	//|	  IsValidEntityID	 |
+	//\----------------------/------------------------------------
+	// False for IDs whose entity has been destroyed, even if the slot
+	// has since been reused
+	bool World::IsValidEntityID(EntityID entityID) const
+	{
+		EntityID index{ GetEntityIndex(entityID) };
+		EntityID generation{ GetEntityGeneration(entityID) };
+		return index < m_entityGenerations.Size() &&
+			(generation & 1) && m_entityGenerations[index] == generation;
 	}
 	//+----------------------\------------------------------------
 	//|	   EntityExists 	 |
 	//\----------------------/------------------------------------
 	bool World::EntityExists(EntityID entityID) const
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		return m_componentBits[entityID].any() || m_flagBits[entityID].any();
+		return IsValidEntityID(entityID);
 	}
 	//+----------------------\------------------------------------
 	//|	    HasComponent	 |
 	//\----------------------/------------------------------------
 	bool World::HasComponent(EntityID entityID, ComponentBit component) const
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		return m_componentBits[entityID].test(component);
+		return IsValidEntityID(entityID) && m_componentBits[entityID].test(component);
 	}
 	//+----------------------\------------------------------------
 	//|	    HasComponents	 |
 	//\----------------------/------------------------------------
 	bool World::HasComponentSet(EntityID entityID, ComponentBitset componentBits) const
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		return (m_componentBits[entityID] & componentBits) == componentBits;
+		return IsValidEntityID(entityID) && (m_componentBits[entityID] & componentBits) == componentBits;
 	}
 	//+----------------------\------------------------------------
 	//|		  HasFlag		 |
 	//\----------------------/------------------------------------
 	bool World::HasFlag(EntityID entityID, FlagBit flagBit) const
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		return m_flagBits[entityID].test(flagBit);
+		return IsValidEntityID(entityID) && m_flagBits[entityID].test(flagBit);
 	}
 	//+----------------------\------------------------------------
 	//|		 HasFlags		 |
 	//\----------------------/------------------------------------
 	bool World::HasFlagSet(EntityID entityID, FlagBitset flagBits) const
 	{
-		d2Assert(entityID < WORLD_MAX_ENTITIES);
-		return (m_flagBits[entityID] & flagBits) == flagBits;
+		return IsValidEntityID(entityID) && (m_flagBits[entityID] & flagBits) == flagBits;
 	}
 	//+----------------------\------------------------------------
 	//|		 IsActive		 |
@@ -112,75 +233,34 @@ namespace Space
 	//+------------------------------\----------------------------
 	//|		 GetClosestEntities		 |
 	//\------------------------------/----------------------------
-	// Get <id, boundingRadiiGap> of count closest entities
-	std::list<std::pair<EntityID, float>> World::GetClosestEntities(const b2Vec2& position, 
-		float radius, unsigned count) const
+	// Get <id, boundingRadiiGap> of count closest entities, closest first
+	void World::GetClosestEntities(const b2Vec2& position, float radius, unsigned count,
+		std::vector<std::pair<EntityID, float>>& closestEntitiesOut) const
 	{
-		b2Body* b2BodyPtr = m_b2WorldPtr->GetBodyList();
-		if(!b2BodyPtr || count < 1)
-			return {};
-
-		std::list<std::pair<EntityID, float>> closestEntityList;
-		while(b2BodyPtr)
-		{
-			Body* bodyPtr = GetUserBodyPtr(b2BodyPtr);
-			if(bodyPtr)
-			{
-				float gap = GetBoundingRadiiGap(position, radius,
-					b2BodyPtr->GetPosition(), m_boundingRadiusComponents[bodyPtr->entityID]);
-
-				// Insert into list if closer than others
-				auto it = closestEntityList.begin();
-				for(unsigned i = 0; i < count; i++, it++)
-				{
-					if(it == closestEntityList.end() || gap < it->second)
-					{
-						it = closestEntityList.insert(it, std::make_pair(bodyPtr->entityID, gap));
-						break;
-					}
-				}
-
-				// Don't let list grow beyond requested number
-				if(closestEntityList.size() > count)
-					closestEntityList.resize(count);
-
-				b2BodyPtr = b2BodyPtr->GetNext();
-			}
-		}
-
-		return closestEntityList;
+		m_spatialGrid.QueryClosest(position, radius, count, closestEntitiesOut);
 	}
-
 	//+------------------------------\----------------------------
 	//|		  GetEntitiesInArea		 |
 	//\------------------------------/----------------------------
 	// Get id of entities whose bounding circle intersects with given area
-	std::vector<EntityID> World::GetEntitiesInArea(const b2Vec2& position, float radius) const
+	void World::GetEntitiesInArea(const b2Vec2& position, float radius, std::vector<EntityID>& entityIDsOut) const
 	{
-		b2Body* b2BodyPtr = m_b2WorldPtr->GetBodyList();
-		if(!b2BodyPtr)
-			return {};
-
-		std::vector<EntityID> entityList;
-		while(b2BodyPtr)
-		{
-			Body* bodyPtr = GetUserBodyPtr(b2BodyPtr);
-			if(bodyPtr)
-			{
-				float gap = GetBoundingRadiiGap(position, radius,
-					b2BodyPtr->GetPosition(), m_boundingRadiusComponents[bodyPtr->entityID]);
-				if(gap <= 0.0f)
-					entityList.push_back(bodyPtr->entityID);
-			}
-		}
-		return entityList;
+		m_spatialGrid.QueryRadius(position, radius, entityIDsOut);
+	}
+	//+------------------------------\----------------------------
+	//|		  GetEntitiesInAreas	 |
+	//\------------------------------/----------------------------
+	// Results for queries[i] are resultsOut[i]
+	void World::GetEntitiesInAreas(const std::vector<AreaQuery>& queries, AreaQueryResults& resultsOut)
+	{
+		m_spatialGrid.QueryRadii(queries, resultsOut, &m_systemScheduler.GetWorkerPool());
 	}
-	RadarComponent World::GetRadarComponent(EntityID entityID) const
+	const std::vector<EntityID>& World::GetEntitiesInRadarRange(EntityID entityID) const
 	{
 		if(HasComponent(entityID, COMPONENT_RADAR))
-			return m_radarComponents[entityID];
+			return m_radarComponents[entityID].entitiesInRange;
 		else
-			return {};
+			return m_emptyRadarEntityIDs;
 	}
 	unsigned World::GetNumFixtures(EntityID entityID) const
 	{
@@ -195,16 +275,20 @@ namespace Space
 	int World::GetDrawLayer(EntityID entityID) const
 	{
 		if(EntityExists(entityID))
-			return m_drawAnimationComponents[entityID].layer;
+			return m_drawLayers[entityID];
 		else
 			return 0;
 	}
 	float World::GetFuelLevel(EntityID entityID) const
 	{
+		if(!HasComponent(entityID, COMPONENT_FUEL))
+			return 0.0f;
 		return m_fuelComponents[entityID].level;
 	}
 	float World::GetMaxFuelLevel(EntityID entityID) const
 	{
+		if(!HasComponent(entityID, COMPONENT_FUEL))
+			return 0.0f;
 		return m_fuelComponents[entityID].max;
 	}
 	float World::GetTotalThrusterAcceleration(EntityID id) const
@@ -217,7 +301,7 @@ namespace Space
 					totalAcceleration += m_thrusterComponents[id].thrusters[i].acceleration;
 			// Boost
 			if(HasComponent(id, COMPONENT_BOOSTER))
-				if(m_boosterComponents[id].secondsLeft > 0.0f)
+				if(m_boosterComponents[id].boosting)
 					totalAcceleration *= m_boosterComponents[id].factor;
 		}
 		return totalAcceleration;
@@ -232,7 +316,7 @@ namespace Space
 					totalFuelRequired += dt * m_thrusterComponents[id].thrusters[i].fuelPerSecond * m_thrusterComponents[id].factor;
 			// Boost
 			if(HasComponent(id, COMPONENT_BOOSTER))
-				if(m_boosterComponents[id].secondsLeft > 0.0f)
+				if(m_boosterComponents[id].boosting)
 					totalFuelRequired *= m_boosterComponents[id].factor * WORLD_BOOST_FUEL_USE_PENALTY_FACTOR;
 
 		}
@@ -255,10 +339,10 @@ namespace Space
 	//\-------------------------/
 	//	Failure to ensure entity has a physics component will result in undefined behavior
 	//+-----------------------------------------------------------------------
-	const b2Vec2& World::GetLinearVelocity(EntityID entityID) const
+	b2Vec2 World::GetLinearVelocity(EntityID entityID) const
 	{
 		d2Assert(HasPhysics(entityID));
-		return m_physicsComponents[entityID].mainBody.b2BodyPtr->GetLinearVelocity();
+		return m_bodyStates.GetLinearVelocity(entityID);
 	}
 	//+-------------------------\---------------------------------------------
 	//|	  GetAngularVelocity	|
@@ -268,7 +352,7 @@ namespace Space
 	float World::GetAngularVelocity(EntityID entityID) const
 	{
 		d2Assert(HasPhysics(entityID));
-		return m_physicsComponents[entityID].mainBody.b2BodyPtr->GetAngularVelocity();
+		return m_bodyStates.GetAngularVelocity(entityID);
 	}
 	//+-------------------------\---------------------------------------------
 	//|	 GetLocalCenterOfMass	|
@@ -286,10 +370,10 @@ namespace Space
 	//\---------------------/
 	//	Failure to ensure entity has a physics component will result in undefined behavior
 	//+-----------------------------------------------------------------------
-	const b2Vec2& World::GetWorldCenter(EntityID entityID) const
+	b2Vec2 World::GetWorldCenter(EntityID entityID) const
 	{
 		d2Assert(HasPhysics(entityID));
-		return m_physicsComponents[entityID].mainBody.b2BodyPtr->GetWorldCenter();
+		return m_bodyStates.GetWorldCenter(entityID);
 	}
 
 	//**********************  Private Functions  *****************************
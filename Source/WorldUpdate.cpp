@@ -10,6 +10,7 @@
 #include "pch.h"
 #include "World.h"
 #include "ParticleSystem.h"
+#include "AllocationCounter.h"
 #include <iomanip>
 
 namespace Space
@@ -24,6 +25,7 @@ namespace Space
 
 		// Add time to internal buffer
 		m_timestepAccumulator += dt;
+		m_emptyPhysicsStepCount = 0;
 
 		// Calculate the number of physics steps to take
 		float stepTime{ 1.0f / m_settings.stepsPerSecond };
@@ -42,42 +44,190 @@ namespace Space
 	}
 	void World::SingleUpdateStep(float dt, PlayerController& playerController)
 	{
-		UpdateEntityCount();
-		UpdateDestructionDelayComponents(dt);
-		UpdatePlayerControllerComponents(dt, playerController);
-		UpdateRotatorComponents();
-		UpdateSetThrustFactorAfterDelayComponents(dt);
-		UpdateThrusterComponents(dt);
-		UpdateBoosterComponents(dt);
-		UpdateBrakeComponents();
-		UpdateProjectileLauncherComponents(dt, false);
-		UpdateProjectileLauncherComponents(dt, true);
-		UpdatePhysics(dt);
-		m_particleSystem.Update(dt);
-		UpdateDrawAnimationComponents(dt);
+		ScopedTimer timer{ m_profilerPtr, m_profilerPhases.updateStep };
+		uint64_t allocationCountBefore{ GetAllocationCount() };
+		m_stepTime = dt;
+		m_stepPlayerControllerPtr = &playerController;
+		m_systemScheduler.Run();
+
+		// Steady-state steps should not touch the heap
+		m_lastStepAllocationCount = (unsigned)(GetAllocationCount() - allocationCountBefore);
+		if(m_lastStepAllocationCount > 0)
+			++m_allocatingStepCount;
+		++m_updateStepCount;
+	}
+	//+-----------------\-----------------------------------------------------
+	//|   AddSystems	| (private)
+	//\-----------------/-----------------------------------------------------
+	// Systems in the order SingleUpdateStep runs them, with what each one reads and writes.
+	// Anything that calls into Box2D writes RESOURCE_B2WORLD, anything that applies forces or
+	// impulses writes RESOURCE_BODY_WRITES, anything that calls Destroy()
+	// writes RESOURCE_DESTROY_BUFFER, and anything that adds or removes components or entities
+	// writes everything.
+	void World::AddSystems()
+	{
+		auto resources = [](std::initializer_list<size_t> bits)
+		{
+			ResourceBitset resourceBits;
+			for(size_t bit : bits)
+				resourceBits.set(bit);
+			return resourceBits;
+		};
+		const ResourceBitset ALL{ ResourceBitset{}.set() };
+
+		m_systemScheduler.Clear();
+		m_systemScheduler.AddSystem("EntityCount", resources({ RESOURCE_ENTITIES }), resources({ RESOURCE_STATS }),
+			[this] { UpdateEntityCount(); });
+		m_systemScheduler.AddSystem("Timers", {}, ALL,
+			[this] { UpdateTimers(); });
+		m_systemScheduler.AddSystem("PlayerController", resources({ RESOURCE_ENTITIES }),
+			resources({ COMPONENT_PRIMARY_PROJECTILE_LAUNCHER, COMPONENT_SECONDARY_PROJECTILE_LAUNCHER,
+				COMPONENT_ROTATOR, COMPONENT_THRUSTER, COMPONENT_BOOSTER, COMPONENT_BRAKE, RESOURCE_TIMERS }),
+			[this] { UpdatePlayerControllerComponents(m_stepTime, *m_stepPlayerControllerPtr); });
+		m_systemScheduler.AddSystem("Rotator", resources({ RESOURCE_ENTITIES, COMPONENT_ROTATOR }),
+			resources({ COMPONENT_PHYSICS, RESOURCE_B2WORLD }),
+			[this] { UpdateRotatorComponents(); });
+		m_systemScheduler.AddSystem("Thruster", resources({ RESOURCE_ENTITIES, COMPONENT_BOOSTER, COMPONENT_PHYSICS, RESOURCE_B2WORLD }),
+			resources({ COMPONENT_THRUSTER, COMPONENT_FUEL, RESOURCE_BODY_WRITES }),
+			[this] { UpdateThrusterComponents(m_stepTime); });
+		m_systemScheduler.AddSystem("Brake", resources({ RESOURCE_ENTITIES, COMPONENT_BRAKE, COMPONENT_PHYSICS, RESOURCE_B2WORLD }),
+			resources({ RESOURCE_BODY_WRITES }),
+			[this] { UpdateBrakeComponents(); });
+		m_systemScheduler.AddSystem("PrimaryProjectileLauncher", {}, ALL,
+			[this] { UpdateProjectileLauncherComponents(false); });
+		m_systemScheduler.AddSystem("SecondaryProjectileLauncher", {}, ALL,
+			[this] { UpdateProjectileLauncherComponents(true); });
+		m_systemScheduler.AddSystem("Physics", {}, ALL,
+			[this] { UpdatePhysics(m_stepTime); });
+		m_systemScheduler.AddSystem("RayProjectiles", resources({ RESOURCE_ENTITIES, COMPONENT_PHYSICS }),
+			resources({ COMPONENT_HEALTH, RESOURCE_DESTROY_BUFFER, RESOURCE_BODY_WRITES, RESOURCE_B2WORLD }),
+			[this] { UpdateRayProjectiles(m_stepTime); });
+		m_systemScheduler.AddSystem("Particles", {}, resources({ RESOURCE_PARTICLES }),
+			[this] { m_particleSystem.Update(m_stepTime); });
+		m_systemScheduler.AddSystem("DrawAnimation", resources({ RESOURCE_ENTITIES }),
+			resources({ COMPONENT_DRAW_ANIMATION, RESOURCE_DESTROY_BUFFER }),
+			[this] { UpdateDrawAnimationComponents(m_stepTime); });
 	}
 	void World::UpdateEntityCount()
 	{
 		// Keep track of how close we get to running out of bodies
 		m_highestActiveEntityCount = std::max(GetEntityCount(), m_highestActiveEntityCount);
 	}
-	void World::UpdateDestructionDelayComponents(float dt)
+	//+-------------------------\---------------------------------------------
+	//|	      UpdateTimers		| (private)
+	//\-------------------------/
+	//	Advances the timer wheel one step. A timer only counts if its component
+	//	still holds its handle; components that were removed or re-added have
+	//	cancelled or replaced it. Timers of inactive entities are paused, so
+	//	they don't come up here until the entity is activated.
+	//+-----------------------------------------------------------------------
+	void World::UpdateTimers()
 	{
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(HasComponent(id, COMPONENT_DESTRUCTION_DELAY) && IsActive(id))
-				if(m_destructionDelayComponents[id] > 0.0f)
-				{
-					m_destructionDelayComponents[id] -= dt;
-					if(m_destructionDelayComponents[id] <= 0.0f)
-						Destroy(id);
-				}
+		m_timerWheel.Advance([this](TimerID timerID, const WorldTimer& timer)
+			{
+				TimerID* componentTimerIDPtr{ GetComponentTimerIDPtr(timer) };
+				if(!componentTimerIDPtr || *componentTimerIDPtr != timerID)
+					return;
+				*componentTimerIDPtr = INVALID_TIMER_ID;
+				TimerExpired(timer);
+			});
+	}
+	void World::TimerExpired(const WorldTimer& timer)
+	{
+		EntityID id{ timer.entityID };
+		switch(timer.type)
+		{
+		case WorldTimerType::DESTRUCTION_DELAY:
+			Destroy(id);
+			break;
+
+		case WorldTimerType::SET_THRUST_FACTOR:
+			if(HasComponent(id, COMPONENT_THRUSTER))
+				m_thrusterComponents[id].factor = m_setThrustFactorAfterDelayComponents[id].factor;
+			RemoveComponent(id, COMPONENT_SET_THRUST_AFTER_DELAY);
+			break;
+
+		case WorldTimerType::BOOST_END:
+			// Switch to cooldown mode
+			m_boosterComponents[id].boosting = false;
+			if(m_boosterComponents[id].cooldownSeconds > 0.0f)
+			{
+				m_boosterComponents[id].coolingDown = true;
+				m_boosterComponents[id].timerID = ScheduleTimer(m_boosterComponents[id].cooldownSeconds,
+					{ WorldTimerType::BOOST_COOLDOWN_END, id });
+			}
+			break;
+
+		case WorldTimerType::BOOST_COOLDOWN_END:
+			m_boosterComponents[id].coolingDown = false;
+			break;
+
+		case WorldTimerType::PRIMARY_LAUNCHER_READY:
+			m_primaryProjectileLauncherComponents[id].projectileLaunchers[timer.slot].ready = true;
+			break;
+
+		case WorldTimerType::SECONDARY_LAUNCHER_READY:
+			m_secondaryProjectileLauncherComponents[id].projectileLaunchers[timer.slot].ready = true;
+			break;
+
+		case WorldTimerType::RADAR_REFRESH:
+			RefreshRadar(id);
+			m_radarComponents[id].refreshTimerID = ScheduleTimer(1.0f / m_settings.radarRefreshesPerSecond, timer);
+			break;
+		}
+	}
+	//+-------------------------\---------------------------------------------
+	//|	      ScheduleTimer		| (private)
+	//\-------------------------/
+	//	Converts the delay to whole physics steps, rounding up like the per-step
+	//	countdowns did. A delay of zero fires on the next step. Timers of
+	//	inactive entities start paused.
+	//+-----------------------------------------------------------------------
+	TimerID World::ScheduleTimer(float delay, const WorldTimer& timer)
+	{
+		float steps{ std::ceil(delay * m_settings.stepsPerSecond - 0.001f) };
+		d2d::ClampLow(steps, 1.0f);
+		TimerID timerID{ m_timerWheel.Schedule((uint64_t)steps, timer) };
+		if(!IsActive(timer.entityID))
+			m_timerWheel.Pause(timerID);
+		return timerID;
+	}
+	//+-----------------------------\-----------------------------------------
+	//|	   GetComponentTimerIDPtr	| (private)
+	//\-----------------------------/
+	//	Where the component the timer belongs to keeps its handle,
+	//	or nullptr if the entity no longer has that component.
+	//+-----------------------------------------------------------------------
+	TimerID* World::GetComponentTimerIDPtr(const WorldTimer& timer)
+	{
+		EntityID id{ timer.entityID };
+		switch(timer.type)
+		{
+		case WorldTimerType::DESTRUCTION_DELAY:
+			return HasComponent(id, COMPONENT_DESTRUCTION_DELAY) ? &m_destructionDelayComponents[id] : nullptr;
+		case WorldTimerType::SET_THRUST_FACTOR:
+			return HasComponent(id, COMPONENT_SET_THRUST_AFTER_DELAY) ? &m_setThrustFactorAfterDelayComponents[id].timerID : nullptr;
+		case WorldTimerType::BOOST_END:
+		case WorldTimerType::BOOST_COOLDOWN_END:
+			return HasComponent(id, COMPONENT_BOOSTER) ? &m_boosterComponents[id].timerID : nullptr;
+		case WorldTimerType::PRIMARY_LAUNCHER_READY:
+			return IsValidProjectileLauncherSlot(id, timer.slot, false) ?
+				&m_primaryProjectileLauncherComponents[id].projectileLaunchers[timer.slot].readyTimerID : nullptr;
+		case WorldTimerType::SECONDARY_LAUNCHER_READY:
+			return IsValidProjectileLauncherSlot(id, timer.slot, true) ?
+				&m_secondaryProjectileLauncherComponents[id].projectileLaunchers[timer.slot].readyTimerID : nullptr;
+		case WorldTimerType::RADAR_REFRESH:
+			return HasComponent(id, COMPONENT_RADAR) ? &m_radarComponents[id].refreshTimerID : nullptr;
+		default:
+			return nullptr;
+		}
 	}
 	//+------------------------\----------------------------------
 	//|	   Getting Around	   |
 	//\------------------------/----------------------------------
 	void World::UpdatePlayerControllerComponents(float dt, PlayerController& playerController)
 	{
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
+		for(EntityID id : m_liveEntityIDs)
 			if(HasFlag(id, FLAG_PLAYER_CONTROLLED) && IsActive(id))
 			{
 				if(HasComponent(id, COMPONENT_PRIMARY_PROJECTILE_LAUNCHER))
@@ -91,14 +241,15 @@ namespace Space
 					m_rotatorComponents[id].factor = playerController.turnFactor;
 				}
 
-				ThrusterComponent& thrusterComponent{ m_thrusterComponents[id] };
 				if(HasComponent(id, COMPONENT_THRUSTER))
-					thrusterComponent.factor = playerController.thrustFactor;
+					m_thrusterComponents[id].factor = playerController.thrustFactor;
 				if(playerController.boost && HasComponent(id, COMPONENT_BOOSTER) &&
-					m_boosterComponents[id].secondsLeft <= 0.0f &&
-					m_boosterComponents[id].cooldownSecondsLeft <= 0.0f)
+					!m_boosterComponents[id].boosting &&
+					!m_boosterComponents[id].coolingDown)
 				{
-					m_boosterComponents[id].secondsLeft = m_boosterComponents[id].boostSeconds;
+					m_boosterComponents[id].boosting = true;
+					m_boosterComponents[id].timerID = ScheduleTimer(m_boosterComponents[id].boostSeconds,
+						{ WorldTimerType::BOOST_END, id });
 				}
 
 				if(HasComponent(id, COMPONENT_BRAKE))
@@ -110,21 +261,21 @@ namespace Space
 	{
 		ComponentBitset requiredComponents;
 		requiredComponents.set(COMPONENT_ROTATOR).set(COMPONENT_PHYSICS);
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
+		for(EntityID id : m_rotatorComponents.GetEntityIDs())
 			if(HasComponentSet(id, requiredComponents) && IsActive(id))
 			{
 				// If entity was just turning but now not, stop rotation.
 				if(m_rotatorComponents[id].lastFactor != 0.0f && m_rotatorComponents[id].factor == 0.0f)
-					m_physicsComponents[id].mainBody.b2BodyPtr->SetAngularVelocity(0.0f);
+					SetAngularVelocity(id, 0.0f);
 
 				// If entity is turning, tell it's body to rotate
 				if(m_rotatorComponents[id].factor != 0.0f)
-					m_physicsComponents[id].mainBody.b2BodyPtr->SetAngularVelocity(m_rotatorComponents[id].factor * m_rotatorComponents[id].rotationSpeed);
+					SetAngularVelocity(id, m_rotatorComponents[id].factor * m_rotatorComponents[id].rotationSpeed);
 			}
 	}
 	void World::ApplyThrust(EntityID id, float acceleration)
 	{
-		float angle{ m_physicsComponents[id].mainBody.b2BodyPtr->GetAngle() };
+		float angle{ m_bodyStates.GetAngle(id) };
 		float inputAdjustedForce{ m_physicsComponents[id].mainBody.b2BodyPtr->GetMass() * acceleration * m_thrusterComponents[id].factor };
 		b2Vec2 forceVec{ inputAdjustedForce * cosf(angle), inputAdjustedForce * sinf(angle) };
 		ApplyForceToCenter(id, forceVec);
@@ -133,7 +284,7 @@ namespace Space
 	{
 		ComponentBitset requiredComponents;
 		requiredComponents.set(COMPONENT_THRUSTER).set(COMPONENT_PHYSICS);
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
+		for(EntityID id : m_thrusterComponents.GetEntityIDs())
 			if(HasComponentSet(id, requiredComponents) && IsActive(id))
 				if(m_thrusterComponents[id].factor > 0.0f)
 				{
@@ -162,56 +313,15 @@ namespace Space
 						m_thrusterComponents[id].thrusters[i].animation.Update(dt);
 				}
 	}
-	void World::UpdateSetThrustFactorAfterDelayComponents(float dt)
-	{
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(HasComponent(id, COMPONENT_SET_THRUST_AFTER_DELAY) && IsActive(id))
-			{
-				m_setThrustFactorAfterDelayComponents[id].delay -= dt;
-				if(m_setThrustFactorAfterDelayComponents[id].delay <= 0.0f)
-				{
-					if(HasComponent(id, COMPONENT_THRUSTER))
-						m_thrusterComponents[id].factor = m_setThrustFactorAfterDelayComponents[id].factor;
-					RemoveComponent(id, COMPONENT_SET_THRUST_AFTER_DELAY);
-				}
-			}
-	}
-	void World::UpdateBoosterComponents(float dt)
-	{
-		ComponentBitset requiredComponents;
-		requiredComponents.set(COMPONENT_BOOSTER).set(COMPONENT_PHYSICS);
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(HasComponentSet(id, requiredComponents) && IsActive(id))
-			{
-				if(m_boosterComponents[id].secondsLeft > 0.0f)
-				{
-					// Boost mode
-					m_boosterComponents[id].secondsLeft -= dt;
-					if(m_boosterComponents[id].secondsLeft <= 0.0f)
-					{
-						// Switch to cooldown mode
-						m_boosterComponents[id].cooldownSecondsLeft = m_boosterComponents[id].cooldownSeconds + m_boosterComponents[id].secondsLeft;
-						m_boosterComponents[id].secondsLeft = 0.0f;
-						d2d::ClampLow(m_boosterComponents[id].cooldownSecondsLeft, 0.0f);
-					}
-				}
-				else if(m_boosterComponents[id].cooldownSecondsLeft > 0.0f)
-				{
-					// Cooldown mode
-					m_boosterComponents[id].cooldownSecondsLeft -= dt;
-					d2d::ClampLow(m_boosterComponents[id].cooldownSecondsLeft, 0.0f);
-				}
-			}
-	}
 	void World::UpdateBrakeComponents()
 	{
 		ComponentBitset requiredComponents;
 		requiredComponents.set(COMPONENT_BRAKE).set(COMPONENT_PHYSICS);
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
+		for(EntityID id : m_brakeComponents.GetEntityIDs())
 			if(HasComponentSet(id, requiredComponents) && IsActive(id))
 				if(m_brakeComponents[id].factor > 0.0f)
 				{
-					b2Vec2 unitVelocity{ m_physicsComponents[id].mainBody.b2BodyPtr->GetLinearVelocity() };
+					b2Vec2 unitVelocity{ m_bodyStates.GetLinearVelocity(id) };
 					unitVelocity.Normalize();
 					b2Vec2 brakeForce{ -m_brakeComponents[id].deceleration * m_physicsComponents[id].mainBody.b2BodyPtr->GetMass() * m_brakeComponents[id].factor * unitVelocity };
 					ApplyForceToCenter(id, brakeForce);
@@ -220,9 +330,9 @@ namespace Space
 	//+------------------------\----------------------------------
 	//|	   Weapon Systems	   |
 	//\------------------------/----------------------------------
-	void World::UpdateProjectileLauncherComponents(float dt, bool secondaryLaunchers)
+	void World::UpdateProjectileLauncherComponents(bool secondaryLaunchers)
 	{
-		ComponentArray< ProjectileLauncherComponent >* projectileLauncherComponentsPtr;
+		SparseSet< ProjectileLauncherComponent >* projectileLauncherComponentsPtr;
 		ComponentBitset requiredComponents;
 		requiredComponents.set(COMPONENT_PHYSICS);
 		if(secondaryLaunchers)
@@ -235,18 +345,11 @@ namespace Space
 			projectileLauncherComponentsPtr = &m_primaryProjectileLauncherComponents;
 			requiredComponents.set(COMPONENT_PRIMARY_PROJECTILE_LAUNCHER);
 		}
-		ComponentArray< ProjectileLauncherComponent >& projectileLauncherComponents{ *projectileLauncherComponentsPtr };
+		SparseSet< ProjectileLauncherComponent >& projectileLauncherComponents{ *projectileLauncherComponentsPtr };
 
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
+		for(EntityID id : projectileLauncherComponents.GetEntityIDs())
 			if(HasComponentSet(id, requiredComponents) && IsActive(id))
 			{
-				for(unsigned i = 0; i < projectileLauncherComponents[id].numSlots; ++i)
-				{
-					ProjectileLauncher& launcher{ projectileLauncherComponents[id].projectileLaunchers[i] };
-					if(launcher.intervalAccumulator < launcher.interval)
-						launcher.intervalAccumulator += dt;
-				}
-
 				// If projectile system engaged, fire projectiles
 				if(projectileLauncherComponents[id].factor > 0.0f)
 					for(unsigned i = 0; i < projectileLauncherComponents[id].numSlots; ++i)
@@ -254,16 +357,19 @@ namespace Space
 						ProjectileLauncher& launcher{ projectileLauncherComponents[id].projectileLaunchers[i] };
 						if(launcher.enabled && !launcher.temporarilyDisabled)
 						{
-							if(launcher.intervalAccumulator >= launcher.interval)
+							if(launcher.ready)
 							{
-								b2Body* b2BodyPtr{ m_physicsComponents[id].mainBody.b2BodyPtr };
-								const b2Transform& transform{ b2BodyPtr->GetTransform() };
+								b2Transform transform{ m_bodyStates.GetTransform(id) };
 								b2Vec2 localBulletPosition{ launcher.localRelativePosition * m_sizeComponents[id] };
 								b2Vec2 globalBulletPosition{ b2Mul(transform, localBulletPosition) };
 								LaunchProjectile(launcher.projectileDef,
 									globalBulletPosition, transform.q.GetAngle(), launcher.impulse,
-									b2BodyPtr->GetLinearVelocity(), id);
-								launcher.intervalAccumulator = 0.0f;
+									m_bodyStates.GetLinearVelocity(id), id);
+
+								// Ready again after the interval
+								launcher.ready = false;
+								launcher.readyTimerID = ScheduleTimer(launcher.interval, { secondaryLaunchers ?
+									WorldTimerType::SECONDARY_LAUNCHER_READY : WorldTimerType::PRIMARY_LAUNCHER_READY, id, i });
 							}
 						}
 					}
@@ -274,62 +380,226 @@ namespace Space
 	//\-------------/---------------------------------------------
 	void World::UpdateDrawAnimationComponents(float dt)
 	{
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(HasComponentSet(id, COMPONENT_DRAW_ANIMATION) && IsActive(id))
+		for(EntityID id : m_drawAnimationComponents.GetEntityIDs())
+			if(IsActive(id))
 			{
 				m_drawAnimationComponents[id].animation.Update(dt);
 				if(!m_drawAnimationComponents[id].animation.IsAnimated() && HasFlag(id, FLAG_DESTRUCTION_ON_ANIMATION_COMPLETION))
 					Destroy(id);
 			}
 	}
+	//+-------------------------\---------------------------------------------
+	//|	   UpdateRayProjectiles	| (private)
+	//\-------------------------/
+	//	Moves each swept-ray projectile and casts the segment it covered this step
+	//	against the world. Runs after the physics step, so impulses from hits are
+	//	applied with the next step. Projectiles wrap like teleported entities.
+	//+-----------------------------------------------------------------------
+	void World::UpdateRayProjectiles(float dt)
+	{
+		size_t i{ 0 };
+		while(i < m_rayProjectiles.size())
+		{
+			RayProjectile& ray{ m_rayProjectiles[i] };
+			bool remove{ false };
+			ray.secondsLeft -= dt;
+			if(ray.secondsLeft <= 0.0f)
+				remove = true;
+			else
+			{
+				if(ray.accelerationSecondsLeft > 0.0f)
+				{
+					ray.velocity += (dt * ray.acceleration) * b2Vec2{ cos(ray.angle), sin(ray.angle) };
+					ray.accelerationSecondsLeft -= dt;
+				}
+				ray.animation.Update(dt);
+
+				// Sweep
+				b2Vec2 end{ ray.position + dt * ray.velocity };
+				m_rayCastIndex = i;
+				m_rayHitFixturePtr = nullptr;
+				m_rayTouchedParent = false;
+				if(end != ray.position)
+					m_b2WorldPtr->RayCast(this, ray.position, end);
+
+				// Rays starting inside a shape don't report it, so test the ends too
+				if(ray.ignoreParent)
+				{
+					bool touchingParent{ m_rayTouchedParent ||
+						EntityContainsPoint(ray.parentID, ray.position) || EntityContainsPoint(ray.parentID, end) };
+					if(ray.touchingParent && !touchingParent)
+						ray.ignoreParent = false;
+					ray.touchingParent = touchingParent;
+				}
+
+				if(m_rayHitFixturePtr)
+				{
+					RayProjectileHit(ray);
+					remove = true;
+				}
+				else
+				{
+					ray.lastPosition = ray.position;
+					ray.position = end;
+
+					// Wrap
+					b2Vec2 translation{ b2Vec2_zero };
+					if(end.x < m_worldRect.lowerBound.x)
+						translation.x = m_worldDimensions.x;
+					else if(end.x > m_worldRect.upperBound.x)
+						translation.x = -m_worldDimensions.x;
+					if(end.y < m_worldRect.lowerBound.y)
+						translation.y = m_worldDimensions.y;
+					else if(end.y > m_worldRect.upperBound.y)
+						translation.y = -m_worldDimensions.y;
+					ray.position += translation;
+					ray.lastPosition += translation;
+				}
+			}
+
+			// Swap the last projectile into the hole
+			if(remove)
+			{
+				ray = std::move(m_rayProjectiles.back());
+				m_rayProjectiles.pop_back();
+			}
+			else
+				++i;
+		}
+	}
+	// Asks Box2D for the fixtures at the point and matches their bodies to the entity
+	// by ID, so clone bodies at the world edges count as well as the main body
+	bool World::EntityContainsPoint(EntityID entityID, const b2Vec2& point) const
+	{
+		if(!IsValidEntityID(entityID) || !HasPhysics(entityID))
+			return false;
+
+		class PointQuery : public b2QueryCallback
+		{
+		public:
+			PointQuery(const World& world, EntityID entityID, const b2Vec2& point)
+				: m_world{ world }, m_entityID{ entityID }, m_point{ point }
+			{}
+			bool ReportFixture(b2Fixture* fixturePtr) override
+			{
+				const Body* bodyPtr{ m_world.GetUserBodyPtr(fixturePtr->GetBody()) };
+				if(bodyPtr && bodyPtr->entityID == m_entityID && !fixturePtr->IsSensor() && fixturePtr->TestPoint(m_point))
+				{
+					found = true;
+					return false;
+				}
+				return true;
+			}
+			bool found{ false };
+		private:
+			const World& m_world;
+			EntityID m_entityID;
+			b2Vec2 m_point;
+		};
+		PointQuery query{ *this, entityID, point };
+		b2AABB aabb;
+		aabb.lowerBound = aabb.upperBound = point;
+		m_b2WorldPtr->QueryAABB(&query, aabb);
+		return query.found;
+	}
+	// Treats the hit as a perfectly inelastic collision along the normal. The target takes
+	// the same half of the damage ApplyImpulseDamage gives it, so a weapon does the same
+	// damage whether its projectiles are rays or bodies.
+	void World::RayProjectileHit(const RayProjectile& ray)
+	{
+		Body* bodyPtr{ GetUserBodyFromFixture(m_rayHitFixturePtr) };
+		EntityID id{ bodyPtr->entityID };
+		b2Vec2 hitVelocity{ m_rayHitFixturePtr->GetBody()->GetLinearVelocityFromWorldPoint(m_rayHitPoint) };
+		float impulse{ m_projectilePools[ray.poolIndex].rayMass * std::max(0.0f, -b2Dot(ray.velocity - hitVelocity, m_rayHitNormal)) };
+		if(impulse <= 0.0f)
+			return;
+
+		// Impulses are buffered for main bodies
+		b2Vec2 mainBodyPoint{ m_rayHitPoint };
+		if(bodyPtr->isClone)
+			mainBodyPoint -= GetCloneOffset(static_cast<CloneBody*>(bodyPtr)->section);
+		ApplyLinearImpulseToWorldPoint(id, -impulse * m_rayHitNormal, mainBodyPoint);
+
+		float totalDamage{ impulse * m_settings.damageToImpulseRatio };
+		if(m_settings.damageLogging)
+			d2LogInfo << "Ray projectile hit: Impulse: " << impulse << " Total Damage: " << totalDamage << " on entity " << id;
+		if(totalDamage >= m_settings.minTotalCollisionDamage)
+			AdjustHealth(id, -0.5f * totalDamage);
+	}
 	//+-------------\---------------------------------------------
 	//|	  Physics   |
 	//\-------------/---------------------------------------------
 	void World::UpdatePhysics(float dt)
 	{
-		ProcessDestroyBuffer();
-		SaveVelocities();
-		ResetSmoothStates();
-		SyncClones();
-		m_b2WorldPtr->Step(dt, m_settings.velocityIterationsPerStep, m_settings.positionIterationsPerStep);
-		ProcessDestroyBuffer();
-		SyncClones();
-		WrapEntities();
+		auto startTime{ std::chrono::steady_clock::now() };
+		m_contactEvents.ResetCounts();
+		ProcessContactEventsAndDestroyBuffer();
+		FlushBodyWrites();
+		{
+			ScopedTimer timer{ m_profilerPtr, m_profilerPhases.saveStates };
+			SaveVelocities();
+			ResetSmoothStates();
+		}
+		if(m_settings.wrapMode == WrapMode::CLONES)
+			SyncClones();
+		{
+			ScopedTimer timer{ m_profilerPtr, m_profilerPhases.b2WorldStep };
+			m_b2WorldPtr->Step(dt, m_settings.velocityIterationsPerStep, m_settings.positionIterationsPerStep);
+		}
+		{
+			ScopedTimer timer{ m_profilerPtr, m_profilerPhases.bodyStates };
+			m_bodyStates.RefreshAll();
+		}
+		ProcessContactEventsAndDestroyBuffer();
+		if(m_settings.wrapMode == WrapMode::CLONES)
+		{
+			SyncClones();
+			WrapEntities();
+		}
+		else
+			TeleportEntities();
 		m_b2WorldPtr->ClearForces();
+		UpdateSpatialGrid();
+
+		// Keep track of step time to compare wrap modes, see GetPhysicsStepSeconds
+		m_physicsStepSeconds += std::chrono::duration<double>{ std::chrono::steady_clock::now() - startTime }.count();
+		++m_physicsStepCount;
 	}
 	void World::SaveVelocities()
 	{
 		// Velocities saved for use in calculating particle explosion velocities
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(HasPhysics(id))
-				m_lastLinearVelocities[id] = m_physicsComponents[id].mainBody.b2BodyPtr->GetLinearVelocity();
+		for(size_t i = 0; i < m_bodyStates.Size(); ++i)
+			m_lastLinearVelocities[m_bodyStates.GetEntityIDAt(i)] = m_bodyStates.GetLinearVelocityAt(i);
 	}
 	void World::EmptyPhysicsStep()
 	{
 		m_b2WorldPtr->Step(0.0f, 0, 0);
-		ProcessDestroyBuffer();
+		++m_emptyPhysicsStepCount;
+		ProcessContactEventsAndDestroyBuffer();
 	}
 	void World::ResetSmoothStates()
 	{
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(HasPhysics(id))
-			{
-				m_lastTransforms[id] = m_physicsComponents[id].mainBody.b2BodyPtr->GetTransform();
-				m_smoothedTransforms[id] = m_lastTransforms[id];
-			}
+		for(size_t i = 0; i < m_bodyStates.Size(); ++i)
+		{
+			EntityID id{ m_bodyStates.GetEntityIDAt(i) };
+			m_lastTransforms[id] = m_smoothedTransforms[id] = m_bodyStates.GetTransformAt(i);
+		}
 	}
 	void World::SyncClones()
 	{
+		ScopedTimer timer{ m_profilerPtr, m_profilerPhases.syncClones };
 		// For each entity, use quadrant to determine which clones it should have.
 		// Then replace old clones with new ones at correct locations while retaining
 		// existing ones which are already at the correct location.
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(HasPhysics(id) && IsActive(id))
+		for(EntityID id : m_physicsComponents.GetEntityIDs())
+			if(IsActive(id))
 			{
 				// Determine locations of clones we should have
-				CloneSectionList newCloneSections{ GetCloneSectionList(*m_physicsComponents[id].mainBody.b2BodyPtr) };
-				std::queue<CloneSection> locationsNeedingHomes;
-				std::queue<unsigned> availableIndices;
+				CloneSectionList newCloneSections{ GetCloneSectionList(m_bodyStates.GetWorldCenter(id)) };
+				std::array<CloneSection, WORLD_NUM_CLONES> locationsNeedingHomes;
+				std::array<unsigned, WORLD_NUM_CLONES> availableIndices;
+				unsigned numLocationsNeedingHomes{ 0 };
+				unsigned numAvailableIndices{ 0 };
 
 				// Make a list of locations that should have a clone but currently do not
 				for(unsigned i = 0; i < WORLD_NUM_CLONES; ++i)
@@ -342,7 +612,7 @@ namespace Space
 							break;
 						}
 					if(needsHome)
-						locationsNeedingHomes.push(newCloneSections[i]);
+						locationsNeedingHomes[numLocationsNeedingHomes++] = newCloneSections[i];
 				}
 
 				// Decide which spots the new clones will over-write
@@ -356,64 +626,128 @@ namespace Space
 							break;
 						}
 					if(indexAvailable)
-						availableIndices.push(i);
+						availableIndices[numAvailableIndices++] = i;
 				}
 
 				// Over-write clone locations
-				while(!locationsNeedingHomes.empty())
-				{
-					d2Assert(!availableIndices.empty() && "No available index for location needing a home.");
-					m_physicsComponents[id].cloneBodyList[availableIndices.front()].section = locationsNeedingHomes.front();
-					locationsNeedingHomes.pop();
-					availableIndices.pop();
-				}
-
-				// De-activate clone bodies that need syncing
-				b2Body* mainB2BodyPtr{ m_physicsComponents[id].mainBody.b2BodyPtr };
-				float angle{ mainB2BodyPtr->GetAngle() };
-				float angularVelocity{ mainB2BodyPtr->GetAngularVelocity() };
+				d2Assert(numAvailableIndices >= numLocationsNeedingHomes && "No available index for location needing a home.");
+				for(unsigned i = 0; i < numLocationsNeedingHomes; ++i)
+					m_physicsComponents[id].cloneBodyList[availableIndices[i]].section = locationsNeedingHomes[i];
+
+				// Sync clone bodies in a single pass. Moving a clone is deferred by the
+				// broadphase until the next b2World::Step, so no empty steps are needed.
+				// Clones that jump are disabled while they move so their old contacts end.
+				b2Vec2 position{ m_bodyStates.GetPosition(id) };
+				float angle{ m_bodyStates.GetAngle(id) };
+				b2Vec2 linearVelocity{ m_bodyStates.GetLinearVelocity(id) };
+				float angularVelocity{ m_bodyStates.GetAngularVelocity(id) };
+				float boundingRadius{ m_boundingRadiusComponents[id] };
 				for(unsigned i = 0; i < WORLD_NUM_CLONES; ++i)
 				{
 					CloneBody& cloneBody{ m_physicsComponents[id].cloneBodyList[i] };
-					CloneSyncData& cloneSyncData{ m_cloneSyncDataArrays[id][i] };
-
-					cloneSyncData.positionNeedsSync = NeedsSync(cloneBody.b2BodyPtr->GetPosition(), mainB2BodyPtr->GetPosition() + GetCloneOffset(cloneBody.section));
-					cloneSyncData.velocityNeedsSync = NeedsSync(cloneBody.b2BodyPtr->GetLinearVelocity(), mainB2BodyPtr->GetLinearVelocity());
-					cloneSyncData.angleNeedsSync = NeedsSync(cloneBody.b2BodyPtr->GetAngle(), angle);
-					cloneSyncData.angularVelocityNeedsSync = NeedsSync(cloneBody.b2BodyPtr->GetAngularVelocity(), angularVelocity);
+					b2Vec2 clonePosition{ position + GetCloneOffset(cloneBody.section) };
 
-					cloneSyncData.needsReactivation = (cloneSyncData.positionNeedsSync || cloneSyncData.angleNeedsSync);
-					if(cloneSyncData.needsReactivation)
-						cloneBody.b2BodyPtr->SetEnabled(false);
-				}
-
-			}
-		EmptyPhysicsStep();
+					// Clone bodies only exist near the world edge. They are released further
+					// from the edge than they are created so they don't come and go every step.
+					if(!cloneBody.b2BodyPtr)
+					{
+						if(NeedsCloneBody(cloneBody.section, position, boundingRadius, m_settings.cloneMargin))
+							CreateCloneBody(id, cloneBody, clonePosition);
+						continue;
+					}
+					if(!NeedsCloneBody(cloneBody.section, position, boundingRadius, 2.0f * m_settings.cloneMargin))
+					{
+						DestroyCloneBody(cloneBody);
+						continue;
+					}
 
-		// Now that the proper clone locations are in place, update states as necessary
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(HasPhysics(id) && IsActive(id))
-			{
-				b2Body* mainB2BodyPtr{ m_physicsComponents[id].mainBody.b2BodyPtr };
-				for(unsigned i = 0; i < WORLD_NUM_CLONES; ++i)
-				{
-					CloneBody& cloneBody{ m_physicsComponents[id].cloneBodyList[i] };
-					CloneSyncData& syncData{ m_cloneSyncDataArrays[id][i] };
+					CloneSyncData syncData;
+					syncData.positionNeedsSync = NeedsSync(cloneBody.b2BodyPtr->GetPosition(), clonePosition);
+					syncData.velocityNeedsSync = NeedsSync(cloneBody.b2BodyPtr->GetLinearVelocity(), linearVelocity);
+					syncData.angleNeedsSync = NeedsSync(cloneBody.b2BodyPtr->GetAngle(), angle);
+					syncData.angularVelocityNeedsSync = NeedsSync(cloneBody.b2BodyPtr->GetAngularVelocity(), angularVelocity);
+					syncData.needsReactivation = (syncData.positionNeedsSync || syncData.angleNeedsSync);
 
-					if(syncData.positionNeedsSync || syncData.angleNeedsSync)
+					if(syncData.needsReactivation)
 					{
-						b2Vec2 clonePosition{ mainB2BodyPtr->GetPosition() + GetCloneOffset(cloneBody.section) };
-						cloneBody.b2BodyPtr->SetTransform(clonePosition, mainB2BodyPtr->GetAngle());
+						cloneBody.b2BodyPtr->SetEnabled(false);
+						cloneBody.b2BodyPtr->SetTransform(clonePosition, angle);
 					}
 					if(syncData.velocityNeedsSync)
-						cloneBody.b2BodyPtr->SetLinearVelocity(mainB2BodyPtr->GetLinearVelocity());
+						cloneBody.b2BodyPtr->SetLinearVelocity(linearVelocity);
 					if(syncData.angularVelocityNeedsSync)
-						cloneBody.b2BodyPtr->SetAngularVelocity(mainB2BodyPtr->GetAngularVelocity());
+						cloneBody.b2BodyPtr->SetAngularVelocity(angularVelocity);
 					if(syncData.needsReactivation)
 						cloneBody.b2BodyPtr->SetEnabled(true);
 				}
 			}
-		EmptyPhysicsStep();
+	}
+	//+-------------------------\---------------------------------------------
+	//|	    NeedsCloneBody		| (private)
+	//\-------------------------/
+	//	A clone in a section is needed when the entity's bounding circle, grown by
+	//	margin, reaches over the world edge opposite that section.
+	//+-----------------------------------------------------------------------
+	bool World::NeedsCloneBody(CloneSection cloneSection, const b2Vec2& position, float boundingRadius, float margin) const
+	{
+		float reach{ boundingRadius + margin };
+		bool nearLeft{ position.x - reach < m_worldRect.lowerBound.x };
+		bool nearRight{ position.x + reach > m_worldRect.upperBound.x };
+		bool nearBottom{ position.y - reach < m_worldRect.lowerBound.y };
+		bool nearTop{ position.y + reach > m_worldRect.upperBound.y };
+		switch(cloneSection)
+		{
+		case CloneSection::TOP_LEFT:		return nearRight && nearBottom;
+		case CloneSection::TOP:				return nearBottom;
+		case CloneSection::TOP_RIGHT:		return nearLeft && nearBottom;
+		case CloneSection::RIGHT:			return nearLeft;
+		case CloneSection::BOTTOM_RIGHT:	return nearLeft && nearTop;
+		case CloneSection::BOTTOM:			return nearTop;
+		case CloneSection::BOTTOM_LEFT:		return nearRight && nearTop;
+		case CloneSection::LEFT: default:	return nearRight;
+		}
+	}
+	void World::CreateCloneBody(EntityID entityID, CloneBody& cloneBody, const b2Vec2& position)
+	{
+		d2Assert(!cloneBody.b2BodyPtr);
+		b2Body& mainB2Body{ *m_physicsComponents[entityID].mainBody.b2BodyPtr };
+		b2BodyDef bodyDef;
+		bodyDef.type = mainB2Body.GetType();
+		bodyDef.awake = mainB2Body.IsAwake();
+		bodyDef.enabled = mainB2Body.IsEnabled();
+		bodyDef.position = position;
+		bodyDef.angle = mainB2Body.GetAngle();
+		bodyDef.linearVelocity = mainB2Body.GetLinearVelocity();
+		bodyDef.angularVelocity = mainB2Body.GetAngularVelocity();
+		bodyDef.fixedRotation = mainB2Body.IsFixedRotation();
+		bodyDef.bullet = mainB2Body.IsBullet();
+		SetB2BodyPtr(&cloneBody, m_b2WorldPtr->CreateBody(&bodyDef));
+
+		// Copy fixtures from the main body
+		for(b2Fixture* fixturePtr = mainB2Body.GetFixtureList(); fixturePtr; fixturePtr = fixturePtr->GetNext())
+		{
+			b2FixtureDef fixtureDef;
+			fixtureDef.shape = fixturePtr->GetShape();
+			fixtureDef.userData = fixturePtr->GetUserData();
+			fixtureDef.friction = fixturePtr->GetFriction();
+			fixtureDef.restitution = fixturePtr->GetRestitution();
+			fixtureDef.restitutionThreshold = fixturePtr->GetRestitutionThreshold();
+			fixtureDef.density = fixturePtr->GetDensity();
+			fixtureDef.isSensor = fixturePtr->IsSensor();
+			fixtureDef.filter = fixturePtr->GetFilterData();
+			cloneBody.b2BodyPtr->CreateFixture(&fixtureDef);
+		}
+
+		++m_cloneBodyCount;
+		m_highestCloneBodyCount = std::max(m_cloneBodyCount, m_highestCloneBodyCount);
+	}
+	void World::DestroyCloneBody(CloneBody& cloneBody)
+	{
+		d2Assert(cloneBody.b2BodyPtr);
+		m_b2WorldPtr->DestroyBody(cloneBody.b2BodyPtr);
+		cloneBody.b2BodyPtr = nullptr;
+		d2Assert(m_cloneBodyCount > 0);
+		--m_cloneBodyCount;
 	}
 	bool World::NeedsSync(float actualValue, float perfectValue) const
 	{
@@ -427,8 +761,16 @@ namespace Space
 	}
 	void World::ProcessDestroyBuffer()
 	{
-		for(EntityID id : m_destroyBuffer)
+		ScopedTimer timer{ m_profilerPtr, m_profilerPhases.destroyBuffer };
+		// Indexed because listeners may destroy more entities while the buffer is processed
+		for(size_t i = 0; i < m_destroyBuffer.size(); ++i)
 		{
+			EntityID id{ m_destroyBuffer[i] };
+
+			// Skip IDs that were already destroyed, including repeats in the buffer
+			if(!IsValidEntityID(id))
+				continue;
+
 			// Send notifications to Game
 			if(HasFlag(id, FLAG_EXITED))
 				if(m_exitListenerPtr)
@@ -446,22 +788,24 @@ namespace Space
 
 			RemoveAllFlags(id);
 			RemoveAllComponents(id);
+			RetireEntityID(id);
 		}
 		m_destroyBuffer.clear();
 	}
 	void World::WrapEntities()
 	{
+		ScopedTimer timer{ m_profilerPtr, m_profilerPhases.wrap };
+		// Only entities outside the world rect can need wrapping, usually none or a few
+		m_bodyStates.GetEntitiesOutside(m_worldRect, m_wrapCandidateIDs);
+
 		bool doManualWrapping{ false };
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
+		for(EntityID id : m_wrapCandidateIDs)
 		{
-			if(HasPhysics(id) && IsActive(id))
+			if(IsActive(id))
 			{
-				const b2Vec2& currentPosition{ m_physicsComponents[id].mainBody.b2BodyPtr->GetPosition() };
+				b2Vec2 currentPosition{ m_bodyStates.GetPosition(id) };
 				m_physicsWrapDatas[id].requiresManualWrapping = false;
-				m_physicsWrapDatas[id].crossedLeftBound = (currentPosition.x < m_worldRect.lowerBound.x);
-				m_physicsWrapDatas[id].crossedRightBound = (currentPosition.x > m_worldRect.upperBound.x);
-				m_physicsWrapDatas[id].crossedLowerBound = (currentPosition.y < m_worldRect.lowerBound.y);
-				m_physicsWrapDatas[id].crossedUpperBound = (currentPosition.y > m_worldRect.upperBound.y);
+				SetCrossedBounds(m_physicsWrapDatas[id], currentPosition);
 
 				// Figure out if we can simply switch Box2D bodies or if we have to wrap manually
 				// (we should be able to switch unless an object is going super fast such that
@@ -477,7 +821,7 @@ namespace Space
 				bool cloneIndexFound{ false };
 				for(const CloneBody& cloneBody : m_physicsComponents[id].cloneBodyList)
 				{
-					if(cloneBody.section == cloneSectionWithWhichToSwitchB2BodyPointers)
+					if(cloneBody.section == cloneSectionWithWhichToSwitchB2BodyPointers && cloneBody.b2BodyPtr)
 					{
 						cloneIndex = cloneBody.cloneIndex;
 						cloneIndexFound = true;
@@ -498,6 +842,7 @@ namespace Space
 
 					// Switch b2Body pointers and change section of clone body
 					SwitchB2Bodies(m_physicsComponents[id].mainBody, m_physicsComponents[id].cloneBodyList[cloneIndex]);
+					m_bodyStates.Store(id, m_physicsComponents[id].mainBody.b2BodyPtr);
 					m_physicsComponents[id].cloneBodyList[cloneIndex].section = newCloneSectionAfterSwitch;
 
 					// Notify wrap listener
@@ -520,38 +865,24 @@ namespace Space
 		if(doManualWrapping)
 		{
 			// De-activate bodies flagged for manual wrap
-			for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-				if(HasPhysics(id) && IsActive(id))
+			for(EntityID id : m_wrapCandidateIDs)
+				if(IsActive(id))
 					if(m_physicsWrapDatas[id].requiresManualWrapping)
 						m_physicsComponents[id].mainBody.b2BodyPtr->SetEnabled(false);
 			EmptyPhysicsStep();
 
 			// Manual wraps
-			for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-				if(HasPhysics(id) && IsActive(id))
+			for(EntityID id : m_wrapCandidateIDs)
+				if(IsActive(id))
 					if(m_physicsWrapDatas[id].requiresManualWrapping)
 					{
-						const b2Transform& currentTransform{ m_physicsComponents[id].mainBody.b2BodyPtr->GetTransform() };
-						b2Vec2 translation;
-						if(m_physicsWrapDatas[id].crossedLeftBound)
-							translation.x = m_worldDimensions.x;
-						else if(m_physicsWrapDatas[id].crossedRightBound)
-							translation.x = -m_worldDimensions.x;
-						else
-							translation.x = 0.0f;
-
-						if(m_physicsWrapDatas[id].crossedLowerBound)
-							translation.y = m_worldDimensions.y;
-						else if(m_physicsWrapDatas[id].crossedRightBound)
-							translation.y = -m_worldDimensions.y;
-						else
-							translation.y = 0.0f;
-
+						b2Vec2 translation{ GetWrapTranslation(m_physicsWrapDatas[id]) };
 						if(translation != b2Vec2_zero)
 						{
 							// Wrap entity
-							b2Vec2 wrappedPosition{ m_physicsComponents[id].mainBody.b2BodyPtr->GetPosition() + translation };
-							m_physicsComponents[id].mainBody.b2BodyPtr->SetTransform(wrappedPosition, currentTransform.q.GetAngle());
+							b2Vec2 wrappedPosition{ m_bodyStates.GetPosition(id) + translation };
+							m_physicsComponents[id].mainBody.b2BodyPtr->SetTransform(wrappedPosition, m_bodyStates.GetTransform(id).q.GetAngle());
+							m_bodyStates.Translate(id, translation);
 
 							// Re-activate
 							m_physicsComponents[id].mainBody.b2BodyPtr->SetEnabled(true);
@@ -566,11 +897,62 @@ namespace Space
 								m_wrappedEntityListenerPtr->EntityWrapped(id, translation);
 						}
 					}
+			SyncClones();
 		}
-		SyncClones();
+	}
+	void World::TeleportEntities()
+	{
+		ScopedTimer timer{ m_profilerPtr, m_profilerPhases.wrap };
+		for(EntityID id : m_physicsComponents.GetEntityIDs())
+			if(IsActive(id))
+			{
+				b2Body* b2BodyPtr{ m_physicsComponents[id].mainBody.b2BodyPtr };
+				SetCrossedBounds(m_physicsWrapDatas[id], m_bodyStates.GetPosition(id));
+				b2Vec2 translation{ GetWrapTranslation(m_physicsWrapDatas[id]) };
+				if(translation != b2Vec2_zero)
+				{
+					b2BodyPtr->SetTransform(m_bodyStates.GetPosition(id) + translation, m_bodyStates.GetAngle(id));
+					m_bodyStates.Translate(id, translation);
+
+					// Wrap saved states
+					m_lastTransforms[id].p += translation;
+					m_smoothedTransforms[id].p += translation;
+
+					// Notify wrap listener
+					if(m_wrappedEntityListenerPtr)
+						m_wrappedEntityListenerPtr->EntityWrapped(id, translation);
+				}
 
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			MoveRadarToMainBody(id);
+				// There are no clone bodies, but clone sections still say where to draw copies near the edges
+				CloneSectionList cloneSections{ GetCloneSectionList(m_bodyStates.GetWorldCenter(id)) };
+				for(unsigned i = 0; i < WORLD_NUM_CLONES; ++i)
+					m_physicsComponents[id].cloneBodyList[i].section = cloneSections[i];
+			}
+	}
+	void World::SetCrossedBounds(PhysicsWrapData& wrapData, const b2Vec2& position) const
+	{
+		wrapData.crossedLeftBound = (position.x < m_worldRect.lowerBound.x);
+		wrapData.crossedRightBound = (position.x > m_worldRect.upperBound.x);
+		wrapData.crossedLowerBound = (position.y < m_worldRect.lowerBound.y);
+		wrapData.crossedUpperBound = (position.y > m_worldRect.upperBound.y);
+	}
+	b2Vec2 World::GetWrapTranslation(const PhysicsWrapData& wrapData) const
+	{
+		b2Vec2 translation;
+		if(wrapData.crossedLeftBound)
+			translation.x = m_worldDimensions.x;
+		else if(wrapData.crossedRightBound)
+			translation.x = -m_worldDimensions.x;
+		else
+			translation.x = 0.0f;
+
+		if(wrapData.crossedLowerBound)
+			translation.y = m_worldDimensions.y;
+		else if(wrapData.crossedUpperBound)
+			translation.y = -m_worldDimensions.y;
+		else
+			translation.y = 0.0f;
+		return translation;
 	}
 	//+---------------------------------\-------------------------------------
 	//|  GetCloneSectionFromWrapData	| (private)
@@ -633,19 +1015,28 @@ namespace Space
 		SetB2BodyPtr(&body1, body2.b2BodyPtr);
 		SetB2BodyPtr(&body2, tempPtr);
 	}
+	void World::UpdateSpatialGrid()
+	{
+		ScopedTimer timer{ m_profilerPtr, m_profilerPhases.spatialGrid };
+		for(size_t i = 0; i < m_bodyStates.Size(); ++i)
+		{
+			EntityID id{ m_bodyStates.GetEntityIDAt(i) };
+			m_spatialGrid.Update(id, m_bodyStates.GetPositionAt(i), m_boundingRadiusComponents[id]);
+		}
+	}
 	void World::SmoothStates(float timestepAlpha)
 	{
-		// Use current transform for static bodies, otherwise use interpolated transform
-		for(EntityID id = 0; id < WORLD_MAX_ENTITIES; ++id)
-			if(HasPhysics(id) && IsActive(id))
-			{
-				if(m_physicsComponents[id].mainBody.b2BodyPtr->GetType() == b2_staticBody)
-					m_smoothedTransforms[id] = m_physicsComponents[id].mainBody.b2BodyPtr->GetTransform();
-				else
-					m_smoothedTransforms[id] = d2d::Lerp(m_lastTransforms[id], m_physicsComponents[id].mainBody.b2BodyPtr->GetTransform(), timestepAlpha);
-			}
+		// Static bodies don't move, so their last and current transforms are equal
+		for(size_t i = 0; i < m_bodyStates.Size(); ++i)
+		{
+			EntityID id{ m_bodyStates.GetEntityIDAt(i) };
+			if(IsActive(id))
+				m_smoothedTransforms[id] = d2d::Lerp(m_lastTransforms[id], m_bodyStates.GetTransformAt(i), timestepAlpha);
+		}
 
 		m_particleSystem.SmoothStates(timestepAlpha);
+		for(RayProjectile& ray : m_rayProjectiles)
+			ray.smoothedPosition = ray.lastPosition + timestepAlpha * (ray.position - ray.lastPosition);
 	}
 	//+------------------------\----------------------------------
 	//|	  Physics Callbacks	   |
@@ -693,30 +1084,6 @@ namespace Space
 	void World::BeginContact(b2Contact* contactPtr)
 	{
 		d2Assert(contactPtr && "Box2D Bug");
-		BeginContactRadar(contactPtr->GetFixtureA(), contactPtr->GetFixtureB());
-		BeginContactRadar(contactPtr->GetFixtureB(), contactPtr->GetFixtureA());
-	}
-	void World::BeginContactRadar(b2Fixture* fixturePtr1, b2Fixture* fixturePtr2)
-	{
-		if(fixturePtr1 && fixturePtr2)
-		{
-			if(fixturePtr1->GetUserData().isRadar && !fixturePtr2->IsSensor())
-			{
-				Body* bodyPtr1 = GetUserBodyFromFixture(fixturePtr1);
-				Body* bodyPtr2 = GetUserBodyFromFixture(fixturePtr2);
-				if(bodyPtr1 && bodyPtr2)
-				{
-					EntityID id1 = bodyPtr1->entityID;
-					if(HasComponent(id1, COMPONENT_RADAR))
-					{
-						if(m_radarComponents[id1].bodiesInRange.count(bodyPtr2))
-							m_radarComponents[id1].bodiesInRange[bodyPtr2]++;
-						else
-							m_radarComponents[id1].bodiesInRange[bodyPtr2] = 1;				
-					}
-				}
-			}
-		}
 	}
 	void World::PreSolve(b2Contact* contactPtr, const b2Manifold* oldManifoldPtr)
 	{
@@ -762,13 +1129,11 @@ namespace Space
 		bool isCollector1 = HasComponent(id1, COMPONENT_ICON_COLLECTOR);
 		bool isIcon2 = HasComponent(id2, COMPONENT_POWERUP) && m_powerUpComponents[id2].type == PowerUpType::ICON;
 
+		// The contact must be disabled now; the credits are added after the step
 		if(isCollector1 && isIcon2)
 		{
-			if(m_iconCollectorComponents[id1].creditsPtr)
-				*m_iconCollectorComponents[id1].creditsPtr += (float)m_powerUpComponents[id2].value;
-			m_powerUpComponents[id2].value = 0;
 			contactPtr->SetEnabled(false);
-			Destroy(id2);
+			m_contactEvents.Push({ ContactEventType::ICON_COLLECTED, false, false, id1, id2 });
 		}
 	}
 	void World::PostSolve(b2Contact* contactPtr, const b2ContactImpulse* impulsePtr)
@@ -791,8 +1156,19 @@ namespace Space
 		int numManifoldPoints{ manifoldPtr->pointCount };
 		d2Assert(numManifoldPoints >= 0 && numManifoldPoints <= b2_maxManifoldPoints && "Box2D Bug");
 
-		// Impulse damage
-		ApplyImpulseDamage(bodyPtr1, bodyPtr2, impulsePtr->normalImpulses, numManifoldPoints);
+		// Record impulse for damage after the step
+		float impulse{ 0.0f };
+		for(int i = 0; i < numManifoldPoints; ++i)
+		{
+			if(m_settings.addImpulsesForDamages)
+				impulse += impulsePtr->normalImpulses[i];
+			else
+				impulse = std::max(impulse, impulsePtr->normalImpulses[i]);
+		}
+		b2WorldManifold worldManifold;
+		contactPtr->GetWorldManifold(&worldManifold);
+		m_contactEvents.Push({ ContactEventType::IMPULSE, bodyPtr1->isClone, bodyPtr2->isClone,
+			bodyPtr1->entityID, bodyPtr2->entityID, impulse, worldManifold.normal });
 	}
 	void World::SayGoodbye(b2Joint* joint)
 	{
@@ -802,136 +1178,179 @@ namespace Space
 	{
 
 	}
-	void World::ApplyImpulseDamage(Body* bodyPtr1, Body* bodyPtr2, const float* normalImpulses, unsigned numImpulses)
+	// Finds the closest fixture a swept-ray projectile would collide with, following
+	// ShouldCollide for everything but the contact-only cases
+	float World::ReportFixture(b2Fixture* fixturePtr, const b2Vec2& point, const b2Vec2& normal, float fraction)
 	{
-		// Get impulse
-		std::stringstream damageLog;
-		float totalDamage{ 0.0f };
+		if(fixturePtr->IsSensor())
+			return -1.0f;
+		Body* bodyPtr{ GetUserBodyPtr(fixturePtr->GetBody()) };
+		if(!bodyPtr)
+			return -1.0f;
+		EntityID id{ bodyPtr->entityID };
+		if(m_physicsComponents[id].disableCollisions)
+			return -1.0f;
+
+		const RayProjectile& ray{ m_rayProjectiles[m_rayCastIndex] };
+		if(id == ray.parentID)
 		{
-			float impulse{ 0.0f };
-			if(m_settings.damageLogging)
-				damageLog << "PostSolve: Impulses(" << numImpulses << "): ";
-
-			// Calculate final impulse
-			for(unsigned i = 0; i < numImpulses; ++i)
-			{
-				if(m_settings.addImpulsesForDamages)
-					impulse += normalImpulses[i];
-				else
-					impulse = std::max(impulse, normalImpulses[i]);
-				if(m_settings.damageLogging)
-					damageLog << normalImpulses[i] << ' ';
-			}
-			if(m_settings.damageLogging)
+			m_rayTouchedParent = true;
+			if(ray.ignoreParent)
+				return -1.0f;
+		}
+		if(!ShouldCollideDefaultFiltering(m_projectilePools[ray.poolIndex].rayFilter, fixturePtr->GetFilterData()))
+			return -1.0f;
+
+		// Clip the ray to this hit so only closer fixtures are reported after it
+		m_rayHitFixturePtr = fixturePtr;
+		m_rayHitPoint = point;
+		m_rayHitNormal = normal;
+		return fraction;
+	}
+	void World::EndContact(b2Contact* contactPtr)
+	{
+		// Establish the pair of bodies in contact
+		d2Assert(contactPtr && "Box2D Bug");
+		Body* bodyPtr1 = GetUserBodyFromFixture(contactPtr->GetFixtureA());
+		Body* bodyPtr2 = GetUserBodyFromFixture(contactPtr->GetFixtureB());
+		d2Assert(bodyPtr1 && bodyPtr2);
+		m_contactEvents.Push({ ContactEventType::END_CONTACT, bodyPtr1->isClone, bodyPtr2->isClone,
+			bodyPtr1->entityID, bodyPtr2->entityID });
+	}
+	//+-------------------------\---------------------------------
+	//|	 ProcessContactEvents	 | (private)
+	//\-------------------------/
+	//	Acts on the contacts recorded by the Box2D callbacks during
+	//	the step, in the order they happened. Entities destroyed since
+	//	then are skipped by the component checks.
+	//+-------------------------------------------------------------
+	void World::ProcessContactEvents()
+	{
+		ScopedTimer timer{ m_profilerPtr, m_profilerPhases.contactEvents };
+		ContactEvent event;
+		while(m_contactEvents.Pop(event))
+		{
+			switch(event.type)
 			{
-				if(m_settings.addImpulsesForDamages)
-					damageLog << "Total Impulse: " << impulse;
-				else
-					damageLog << "Max Impulse: " << impulse;
-
-				damageLog << "     IDs: " << bodyPtr1->entityID;
-				if(bodyPtr1->isClone)
-					damageLog << "(clone)";
-				damageLog << " and " << bodyPtr2->entityID;
-				if(bodyPtr2->isClone)
-					damageLog << "(clone)";
-				damageLog << '\n';
+			case ContactEventType::ICON_COLLECTED:
+				CollectIcon(event.entityID1, event.entityID2);
+				break;
+			case ContactEventType::IMPULSE:
+				ApplyImpulseDamage(event);
+				break;
+			case ContactEventType::END_CONTACT:
+				ApplyContactEnd(event);
+				break;
+			default:
+				d2Assert(false);
+				break;
 			}
-
-			// Get total damage
-			totalDamage = impulse * m_settings.damageToImpulseRatio;
 		}
+	}
+	//+-----------------------------------------\-----------------
+	//|	 ProcessContactEventsAndDestroyBuffer	 | (private)
+	//\-----------------------------------------/
+	//	Destroying bodies ends their contacts, and acting on contacts
+	//	can destroy more entities, so alternate until both are empty.
+	//	Otherwise the END_CONTACT events of the last destroyed bodies
+	//	would wait in the buffer until after the next step.
+	//+-------------------------------------------------------------
+	void World::ProcessContactEventsAndDestroyBuffer()
+	{
+		do
+		{
+			ProcessContactEvents();
+			ProcessDestroyBuffer();
+		} while(!m_contactEvents.IsEmpty());
 
+		if(m_contactEvents.GetDroppedCount() > 0)
+			d2LogError << "Error: Contact event buffer full, dropped " << m_contactEvents.GetDroppedCount() << " events";
+	}
+	void World::CollectIcon(EntityID collectorID, EntityID iconID)
+	{
+		if(!HasComponent(collectorID, COMPONENT_ICON_COLLECTOR) || !HasComponent(iconID, COMPONENT_POWERUP))
+			return;
+
+		// Value is zeroed so an icon touching two collectors in one step is only counted once
+		if(m_iconCollectorComponents[collectorID].creditsPtr)
+			*m_iconCollectorComponents[collectorID].creditsPtr += (float)m_powerUpComponents[iconID].value;
+		m_powerUpComponents[iconID].value = 0;
+		Destroy(iconID);
+	}
+	void World::ApplyImpulseDamage(const ContactEvent& event)
+	{
 		// If collision big enough to be worth it
-		if(totalDamage >= m_settings.minTotalCollisionDamage)
+		float totalDamage{ event.impulse * m_settings.damageToImpulseRatio };
+		bool isDamaging{ totalDamage >= m_settings.minTotalCollisionDamage };
+		if(isDamaging)
 		{
-			// Calculate individual damages
-			if(m_settings.damageLogging)
-				damageLog << "     Total Damage: " << std::setw(8) << totalDamage;
-			float damage1, damage2;
-			damage1 = damage2 = 0.5f * totalDamage;
-
-			// Apply damage 1
-			if(!bodyPtr1->isClone)
-			{
-				AdjustHealth(bodyPtr1->entityID, -damage1);
-				if(m_settings.damageLogging)
-					damageLog << " Damage: " << damage1 << " on entity " << bodyPtr1->entityID;
-			}
-
-			// Apply damage 2
-			if(!bodyPtr2->isClone)
-			{
-				AdjustHealth(bodyPtr2->entityID, -damage2);
-				if(m_settings.damageLogging)
-					damageLog << " Damage: " << damage2 << " on entity " << bodyPtr2->entityID;
-			}
-			if(m_settings.damageLogging) damageLog << '\n';
+			float damage{ 0.5f * totalDamage };
+			if(!event.isClone1)
+				AdjustHealth(event.entityID1, -damage);
+			if(!event.isClone2)
+				AdjustHealth(event.entityID2, -damage);
 		}
 		if(m_settings.damageLogging)
-			d2LogInfo << damageLog.str();
+			LogImpulseDamage(event, isDamaging ? totalDamage : 0.0f);
 	}
-	void World::EndContact(b2Contact* contactPtr)
+	// Only called when damageLogging is on, so the stream isn't built for every contact
+	void World::LogImpulseDamage(const ContactEvent& event, float totalDamage) const
 	{
-		// Establish the pair of bodies in contact
-		d2Assert(contactPtr && "Box2D Bug");
-		std::array<Body*, 2> bodyPtrs{
-			GetUserBodyFromFixture(contactPtr->GetFixtureA()),
-				GetUserBodyFromFixture(contactPtr->GetFixtureB()) };
-		d2Assert(bodyPtrs[0] && bodyPtrs[1]);
+		std::stringstream damageLog;
+		if(m_settings.addImpulsesForDamages)
+			damageLog << "PostSolve: Total Impulse: " << event.impulse;
+		else
+			damageLog << "PostSolve: Max Impulse: " << event.impulse;
+
+		damageLog << "     IDs: " << event.entityID1;
+		if(event.isClone1)
+			damageLog << "(clone)";
+		damageLog << " and " << event.entityID2;
+		if(event.isClone2)
+			damageLog << "(clone)";
+		damageLog << '\n';
+
+		if(totalDamage > 0.0f)
+		{
+			float damage{ 0.5f * totalDamage };
+			damageLog << "     Total Damage: " << std::setw(8) << totalDamage;
+			if(!event.isClone1)
+				damageLog << " Damage: " << damage << " on entity " << event.entityID1;
+			if(!event.isClone2)
+				damageLog << " Damage: " << damage << " on entity " << event.entityID2;
+			damageLog << '\n';
+		}
+		d2LogInfo << damageLog.str();
+	}
+	void World::ApplyContactEnd(const ContactEvent& event)
+	{
+		std::array<std::pair<EntityID, bool>, 2> bodies{ {
+			{ event.entityID1, event.isClone1 },
+			{ event.entityID2, event.isClone2 } } };
 
 		// COMPONENT_DESTRUCTION_DELAY_ON_CONTACT
-		for(Body* bodyPtr : bodyPtrs)
-			if(!bodyPtr->isClone && HasComponent(bodyPtr->entityID, COMPONENT_DESTRUCTION_DELAY_ON_CONTACT))
+		for(const auto& [id, isClone] : bodies)
+			if(!isClone && HasComponent(id, COMPONENT_DESTRUCTION_DELAY_ON_CONTACT))
 			{
-				AddDestructionDelayComponent(bodyPtr->entityID, m_destructionDelayOnContactComponents[bodyPtr->entityID]);
-				RemoveComponent(bodyPtr->entityID, COMPONENT_DESTRUCTION_DELAY_ON_CONTACT);
+				AddDestructionDelayComponent(id, m_destructionDelayOnContactComponents[id]);
+				RemoveComponent(id, COMPONENT_DESTRUCTION_DELAY_ON_CONTACT);
 			}
 
 		// COMPONENT_DESTRUCTION_CHANCE_ON_CONTACT
-		for(Body* bodyPtr : bodyPtrs)
-			if(!bodyPtr->isClone && HasComponent(bodyPtr->entityID, COMPONENT_DESTRUCTION_CHANCE_ON_CONTACT))
-				if(d2d::RandomFloatPercent() <= m_destructionChanceOnContactComponents[bodyPtr->entityID])
-					Destroy(bodyPtr->entityID);
+		for(const auto& [id, isClone] : bodies)
+			if(!isClone && HasComponent(id, COMPONENT_DESTRUCTION_CHANCE_ON_CONTACT))
+				if(d2d::RandomFloatPercent() <= m_destructionChanceOnContactComponents[id])
+					Destroy(id);
 
 		// FLAG_IGNORE_PARENT_COLLISIONS_UNTIL_FIRST_CONTACT_END
-		EntityID id1{ bodyPtrs[0]->entityID };
-		EntityID id2{ bodyPtrs[1]->entityID };
+		EntityID id1{ event.entityID1 };
+		EntityID id2{ event.entityID2 };
 		bool entity1IsParentOf2{ HasComponent(id2, COMPONENT_PARENT) && m_parentComponents[id2] == id1 };
 		bool entity2IsParentOf1{ HasComponent(id1, COMPONENT_PARENT) && m_parentComponents[id1] == id2 };
 		if(entity2IsParentOf1 && HasFlag(id1, FLAG_IGNORE_PARENT_COLLISIONS_UNTIL_FIRST_CONTACT_END))
 			SetFlag(id1, FLAG_IGNORE_PARENT_COLLISIONS_UNTIL_FIRST_CONTACT_END, false);
 		if(entity1IsParentOf2 && HasFlag(id2, FLAG_IGNORE_PARENT_COLLISIONS_UNTIL_FIRST_CONTACT_END))
 			SetFlag(id2, FLAG_IGNORE_PARENT_COLLISIONS_UNTIL_FIRST_CONTACT_END, false);
-
-		// Remove bodies from radar components
-		EndContactRadar(contactPtr->GetFixtureA(), contactPtr->GetFixtureB());
-		EndContactRadar(contactPtr->GetFixtureB(), contactPtr->GetFixtureA());
-	}
-	void World::EndContactRadar(b2Fixture* fixturePtr1, b2Fixture* fixturePtr2)
-	{
-		if(fixturePtr1 && fixturePtr2)
-		{
-			if(fixturePtr1->GetUserData().isRadar && !fixturePtr2->IsSensor())
-			{
-				Body* bodyPtr1 = GetUserBodyFromFixture(fixturePtr1);
-				Body* bodyPtr2 = GetUserBodyFromFixture(fixturePtr2);
-				if(bodyPtr1 && bodyPtr2)
-				{
-					EntityID id1 = bodyPtr1->entityID;
-					if(HasComponent(id1, COMPONENT_RADAR))
-					{
-						if(m_radarComponents[id1].bodiesInRange.count(bodyPtr2))
-						{
-							m_radarComponents[id1].bodiesInRange[bodyPtr2]--;
-							if(m_radarComponents[id1].bodiesInRange[bodyPtr2] < 1)
-								m_radarComponents[id1].bodiesInRange.erase(bodyPtr2);
-						}
-					}
-
-				}
-			}
-		}
 	}
 	void World::AdjustHealth(EntityID entityID, float healthChange)
 	{
@@ -958,7 +1377,7 @@ namespace Space
 	void World::CreateExplosionFromEntity(EntityID entityID, const ParticleExplosionComponent& particleExplosion)
 	{
 		unsigned numParticles{ particleExplosion.numParticles };
-		int numParticlesOverflowing{ (int)(m_particleSystem.firstUnusedIndex + numParticles) - (int)MAX_PARTICLES };
+		int numParticlesOverflowing{ (int)(m_particleSystem.GetParticleCount() + numParticles) - (int)MAX_PARTICLES };
 		if(numParticlesOverflowing > 0)
 		{
 			d2LogError << "Error: Ran out of particles!";
@@ -966,25 +1385,18 @@ namespace Space
 		}
 
 		float WEIGHT_OF_CURRENT_VELOCITY{ 0.2f };
-		b2Vec2 explosionVelocity{ d2d::Lerp(m_lastLinearVelocities[entityID], m_physicsComponents[entityID].mainBody.b2BodyPtr->GetLinearVelocity(), WEIGHT_OF_CURRENT_VELOCITY) };
+		b2Vec2 explosionVelocity{ d2d::Lerp(m_lastLinearVelocities[entityID], m_bodyStates.GetLinearVelocity(entityID), WEIGHT_OF_CURRENT_VELOCITY) };
 		float deathDamage{ HasComponent(entityID, COMPONENT_HEALTH) ? m_healthComponents[entityID].deathDamage : 0.0f };
 
-		// Add particles before modifying values
-		ParticleID firstIndex{ m_particleSystem.firstUnusedIndex };
-		m_particleSystem.firstUnusedIndex += numParticles;
-
-		// Timers
-		for(ParticleID i = firstIndex; i < m_particleSystem.firstUnusedIndex; ++i)
+		for(unsigned i = 0; i < numParticles; ++i)
 		{
-			m_particleSystem.timers[i].age = 0.0f;
-			m_particleSystem.timers[i].fadeIn = particleExplosion.fadeIn;
-			m_particleSystem.timers[i].fadeOut = particleExplosion.fadeOut;
-			m_particleSystem.timers[i].lifetime = particleExplosion.lifetime;
-		}
+			ParticleDef particle;
+
+			// Timers
+			particle.fadeIn = particleExplosion.fadeIn;
+			particle.fadeOut = particleExplosion.fadeOut;
+			particle.lifetime = particleExplosion.lifetime;
 
-		// Movements and sizes
-		for(ParticleID i = firstIndex; i < m_particleSystem.firstUnusedIndex; ++i)
-		{
 			// Random direction
 			float randomAngle{ d2d::RandomFloat({0.0f, d2d::TWO_PI}) };
 			b2Vec2 randomUnitVector{ cosf(randomAngle), sinf(randomAngle) };
@@ -992,11 +1404,11 @@ namespace Space
 			// Random point in that direction
 			float diameter{ particleExplosion.relativeSize * (m_sizeComponents[entityID].x + m_sizeComponents[entityID].y) * 0.5f };
 			float randomRadius{ d2d::RandomFloat({0.0f, 0.5f * diameter}) };
-			m_particleSystem.physics[i].position = randomRadius * randomUnitVector + m_smoothedTransforms[entityID].p;
+			particle.position = randomRadius * randomUnitVector + m_smoothedTransforms[entityID].p;
 
 			// Random relativeSize
 			int randomSizeIndex{ d2d::RandomInt(particleExplosion.sizeIndexRange) };
-			m_particleSystem.pointSizeIndices[i] = randomSizeIndex;
+			particle.pointSizeIndex = randomSizeIndex;
 
 			// Speed based on relativeSize
 			float percentOfWayToMaxSpeed;
@@ -1017,31 +1429,54 @@ namespace Space
 			float randomAngleFluctuation{ d2d::RandomFloat({-maxAngleFluctuation, maxAngleFluctuation}) };
 			randomAngle += randomAngleFluctuation;
 			randomUnitVector.Set(cosf(randomAngle), sinf(randomAngle));
-			m_particleSystem.physics[i].velocity = randomSpeedFluctuationFactor * speed * randomUnitVector + explosionVelocity;
-		}
+			particle.velocity = randomSpeedFluctuationFactor * speed * randomUnitVector + explosionVelocity;
 
-		// Layers
-		for(ParticleID i = firstIndex; i < m_particleSystem.firstUnusedIndex; ++i)
-		{
-			int newLayer{ m_drawAnimationComponents[entityID].layer };
-			d2d::RandomBool() ? ++newLayer : --newLayer;
-			d2d::Clamp(newLayer, m_settings.drawLayerRange);
-			m_particleSystem.layers[i] = newLayer;
-		}
+			// Layer
+			particle.layer = m_drawLayers[entityID];
+			d2d::RandomBool() ? ++particle.layer : --particle.layer;
+			d2d::Clamp(particle.layer, m_settings.drawLayerRange);
 
-		// Colors
-		for(ParticleID i = firstIndex; i < m_particleSystem.firstUnusedIndex; ++i)
-			m_particleSystem.colors[i] = particleExplosion.colorRange.Lerp(d2d::RandomFloatPercent());
+			// Color
+			particle.color = particleExplosion.colorRange.Lerp(d2d::RandomFloatPercent());
+
+			m_particleSystem.AddParticle(particle);
+		}
 	}
 	//+------------------------\----------------------------------
 	//|	   Box2D user data     |
 	//\------------------------/----------------------------------
-	Body* World::GetUserBodyPtr(b2Body* b2BodyPtr) const
+	//+-------------------------\---------------------------------------------
+	//|	    GetUserBodyPtr		| (private)
+	//\-------------------------/
+	//	Box2D user data holds the owning entity ID plus one (zero means none).
+	//	The Body is found by matching b2Body pointers, so it stays valid
+	//	while component storage moves around.
+	//+-----------------------------------------------------------------------
+	Body* World::GetUserBodyPtr(b2Body* b2BodyPtr)
 	{
 		if(b2BodyPtr)
-			return reinterpret_cast<Body*>(b2BodyPtr->GetUserData().pointer);
+		{
+			uintptr_t userData{ b2BodyPtr->GetUserData().pointer };
+			if(userData)
+			{
+				EntityID entityID{ (EntityID)(userData - 1) };
+				if(HasPhysics(entityID))
+				{
+					PhysicsComponent& physicsComponent{ m_physicsComponents[entityID] };
+					if(physicsComponent.mainBody.b2BodyPtr == b2BodyPtr)
+						return &physicsComponent.mainBody;
+					for(CloneBody& cloneBody : physicsComponent.cloneBodyList)
+						if(cloneBody.b2BodyPtr == b2BodyPtr)
+							return &cloneBody;
+				}
+			}
+		}
 		return nullptr;
 	}
+	const Body* World::GetUserBodyPtr(b2Body* b2BodyPtr) const
+	{
+		return const_cast<World*>(this)->GetUserBodyPtr(b2BodyPtr);
+	}
 	Body* World::GetUserBodyFromFixture(b2Fixture* fixturePtr)
 	{
 		d2Assert(fixturePtr && "Box2D Bug");
@@ -1061,7 +1496,7 @@ namespace Space
 			bodyPtr->b2BodyPtr = b2BodyPtr;
 			if(bodyPtr->b2BodyPtr)
 			{
-				bodyPtr->b2BodyPtr->GetUserData().pointer = reinterpret_cast<uintptr_t>(bodyPtr);
+				bodyPtr->b2BodyPtr->GetUserData().pointer = (uintptr_t)bodyPtr->entityID + 1;
 			}
 		}
 	}
@@ -1077,9 +1512,12 @@ namespace Space
 		if(HasPhysics(entityID))
 		{
 			m_physicsComponents[entityID].mainBody.b2BodyPtr->SetTransform(position, angle);
-			m_lastTransforms[entityID] = m_smoothedTransforms[entityID] = m_physicsComponents[entityID].mainBody.b2BodyPtr->GetTransform();
+			m_bodyStates.Store(entityID, m_physicsComponents[entityID].mainBody.b2BodyPtr);
+			m_lastTransforms[entityID] = m_smoothedTransforms[entityID] = m_bodyStates.GetTransform(entityID);
+			m_spatialGrid.Update(entityID, position, m_boundingRadiusComponents[entityID]);
 			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->SetTransform(position + GetCloneOffset(cloneBody.section), angle);
+				if(cloneBody.b2BodyPtr)
+					cloneBody.b2BodyPtr->SetTransform(position + GetCloneOffset(cloneBody.section), angle);
 		}
 	}
 	void World::SetLinearVelocity(EntityID entityID, const b2Vec2& velocity)
@@ -1087,8 +1525,7 @@ namespace Space
 		if(HasPhysics(entityID))
 		{
 			m_physicsComponents[entityID].mainBody.b2BodyPtr->SetLinearVelocity(velocity);
-			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->SetLinearVelocity(velocity);
+			m_bodyStates.Store(entityID, m_physicsComponents[entityID].mainBody.b2BodyPtr);
 		}
 	}
 	void World::SetAngularVelocity(EntityID entityID, float angularVelocity)
@@ -1096,103 +1533,148 @@ namespace Space
 		if(HasPhysics(entityID))
 		{
 			m_physicsComponents[entityID].mainBody.b2BodyPtr->SetAngularVelocity(angularVelocity);
-			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->SetAngularVelocity(angularVelocity);
+			m_bodyStates.Store(entityID, m_physicsComponents[entityID].mainBody.b2BodyPtr);
 		}
 	}
 	void World::Activate(EntityID entityID)
 	{
 		SetFlag(entityID, FLAG_ACTIVE, true);
+		SetComponentTimersPaused(entityID, false);
 		if(HasPhysics(entityID))
 		{
 			m_physicsComponents[entityID].mainBody.b2BodyPtr->SetEnabled(true);
 			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->SetEnabled(true);
+				if(cloneBody.b2BodyPtr)
+					cloneBody.b2BodyPtr->SetEnabled(true);
 		}
 	}
 	void World::Deactivate(EntityID entityID)
 	{
 		SetFlag(entityID, FLAG_ACTIVE, false);
+		SetComponentTimersPaused(entityID, true);
 		if(HasPhysics(entityID))
 		{
 			m_physicsComponents[entityID].mainBody.b2BodyPtr->SetEnabled(false);
 			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->SetEnabled(false);
+				if(cloneBody.b2BodyPtr)
+					cloneBody.b2BodyPtr->SetEnabled(false);
 		}
 	}
 	void World::ApplyForceToCenter(EntityID entityID, const b2Vec2& force)
 	{
 		if(HasPhysics(entityID))
 		{
-			m_physicsComponents[entityID].mainBody.b2BodyPtr->ApplyForceToCenter(force, true);
-			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->ApplyForceToCenter(force, true);
+			size_t i{ GetBodyWriteIndex(entityID) };
+			m_bodyWriteForcesX[i] += force.x;
+			m_bodyWriteForcesY[i] += force.y;
 		}
 	}
 	void World::ApplyForceToLocalPoint(EntityID entityID, const b2Vec2& force, const b2Vec2& localPoint)
 	{
 		if(HasPhysics(entityID))
-		{
-			m_physicsComponents[entityID].mainBody.b2BodyPtr->ApplyForce(force, m_physicsComponents[entityID].mainBody.b2BodyPtr->GetWorldPoint(localPoint), true);
-			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->ApplyForce(force, cloneBody.b2BodyPtr->GetWorldPoint(localPoint), true);
-		}
+			ApplyForceToWorldPoint(entityID, force, m_physicsComponents[entityID].mainBody.b2BodyPtr->GetWorldPoint(localPoint));
 	}
 	void World::ApplyForceToWorldPoint(EntityID entityID, const b2Vec2& force, const b2Vec2& worldPoint)
 	{
 		if(HasPhysics(entityID))
 		{
-			m_physicsComponents[entityID].mainBody.b2BodyPtr->ApplyForce(force, worldPoint, true);
-			b2Vec2 localPoint{ m_physicsComponents[entityID].mainBody.b2BodyPtr->GetLocalPoint(worldPoint) };
-			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->ApplyForce(force, cloneBody.b2BodyPtr->GetWorldPoint(localPoint), true);
+			// Same as a force at the center plus the torque it makes about the center
+			b2Vec2 arm{ worldPoint - m_bodyStates.GetWorldCenter(entityID) };
+			size_t i{ GetBodyWriteIndex(entityID) };
+			m_bodyWriteForcesX[i] += force.x;
+			m_bodyWriteForcesY[i] += force.y;
+			m_bodyWriteTorques[i] += b2Cross(arm, force);
 		}
 	}
 	void World::ApplyTorque(EntityID entityID, float torque)
 	{
 		if(HasPhysics(entityID))
-		{
-			m_physicsComponents[entityID].mainBody.b2BodyPtr->ApplyTorque(torque, true);
-			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->ApplyTorque(torque, true);
-		}
+			m_bodyWriteTorques[GetBodyWriteIndex(entityID)] += torque;
 	}
 	void World::ApplyLinearImpulseToCenter(EntityID entityID, const b2Vec2& impulse)
 	{
 		if(HasPhysics(entityID))
 		{
-			m_physicsComponents[entityID].mainBody.b2BodyPtr->ApplyLinearImpulseToCenter(impulse, true);
-			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->ApplyLinearImpulseToCenter(impulse, true);
+			size_t i{ GetBodyWriteIndex(entityID) };
+			m_bodyWriteImpulsesX[i] += impulse.x;
+			m_bodyWriteImpulsesY[i] += impulse.y;
 		}
 	}
 	void World::ApplyLinearImpulseToLocalPoint(EntityID entityID, const b2Vec2& impulse, const b2Vec2& localPoint)
 	{
 		if(HasPhysics(entityID))
-		{
-			m_physicsComponents[entityID].mainBody.b2BodyPtr->ApplyLinearImpulse(impulse, m_physicsComponents[entityID].mainBody.b2BodyPtr->GetWorldPoint(localPoint), true);
-			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->ApplyLinearImpulse(impulse, cloneBody.b2BodyPtr->GetWorldPoint(localPoint), true);
-		}
+			ApplyLinearImpulseToWorldPoint(entityID, impulse, m_physicsComponents[entityID].mainBody.b2BodyPtr->GetWorldPoint(localPoint));
 	}
 	void World::ApplyLinearImpulseToWorldPoint(EntityID entityID, const b2Vec2& impulse, const b2Vec2& worldPoint)
 	{
 		if(HasPhysics(entityID))
 		{
-			m_physicsComponents[entityID].mainBody.b2BodyPtr->ApplyLinearImpulse(impulse, worldPoint, true);
-			b2Vec2 localPoint{ m_physicsComponents[entityID].mainBody.b2BodyPtr->GetLocalPoint(worldPoint) };
-			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->ApplyLinearImpulse(impulse, cloneBody.b2BodyPtr->GetWorldPoint(localPoint), true);
+			b2Vec2 arm{ worldPoint - m_bodyStates.GetWorldCenter(entityID) };
+			size_t i{ GetBodyWriteIndex(entityID) };
+			m_bodyWriteImpulsesX[i] += impulse.x;
+			m_bodyWriteImpulsesY[i] += impulse.y;
+			m_bodyWriteAngularImpulses[i] += b2Cross(arm, impulse);
 		}
 	}
 	void World::ApplyAngularImpulse(EntityID entityID, float impulse)
 	{
 		if(HasPhysics(entityID))
+			m_bodyWriteAngularImpulses[GetBodyWriteIndex(entityID)] += impulse;
+	}
+	//+-------------------------\---------------------------------------------
+	//|	   GetBodyWriteIndex	| (private)
+	//\-------------------------/
+	//	Finds the entity's entry in the body write buffer, adding a zeroed one if needed.
+	//	An index left over from an earlier step is stale when it points past the end
+	//	or at another entity.
+	//+-----------------------------------------------------------------------
+	size_t World::GetBodyWriteIndex(EntityID entityID)
+	{
+		size_t index{ m_bodyWriteIndices[entityID] };
+		if(index < m_bodyWriteEntityIDs.size() && m_bodyWriteEntityIDs[index] == entityID)
+			return index;
+
+		index = m_bodyWriteEntityIDs.size();
+		m_bodyWriteIndices[entityID] = index;
+		m_bodyWriteEntityIDs.push_back(entityID);
+		m_bodyWriteForcesX.push_back(0.0f);
+		m_bodyWriteForcesY.push_back(0.0f);
+		m_bodyWriteTorques.push_back(0.0f);
+		m_bodyWriteImpulsesX.push_back(0.0f);
+		m_bodyWriteImpulsesY.push_back(0.0f);
+		m_bodyWriteAngularImpulses.push_back(0.0f);
+		return index;
+	}
+	//+-------------------------\---------------------------------------------
+	//|	    FlushBodyWrites		| (private)
+	//\-------------------------/
+	//	Applies buffered forces and impulses to main bodies only, once per entity.
+	//	Clones get the resulting velocities from SyncClones.
+	//+-----------------------------------------------------------------------
+	void World::FlushBodyWrites()
+	{
+		ScopedTimer timer{ m_profilerPtr, m_profilerPhases.bodyWrites };
+		for(size_t i = 0; i < m_bodyWriteEntityIDs.size(); ++i)
 		{
-			m_physicsComponents[entityID].mainBody.b2BodyPtr->ApplyAngularImpulse(impulse, true);
-			for(const CloneBody& cloneBody : m_physicsComponents[entityID].cloneBodyList)
-				cloneBody.b2BodyPtr->ApplyAngularImpulse(impulse, true);
+			// Entity may have lost its body since the write
+			EntityID entityID{ m_bodyWriteEntityIDs[i] };
+			if(!HasPhysics(entityID))
+				continue;
+
+			b2Body* b2BodyPtr{ m_physicsComponents[entityID].mainBody.b2BodyPtr };
+			b2BodyPtr->ApplyLinearImpulseToCenter({ m_bodyWriteImpulsesX[i], m_bodyWriteImpulsesY[i] }, true);
+			b2BodyPtr->ApplyAngularImpulse(m_bodyWriteAngularImpulses[i], true);
+			b2BodyPtr->ApplyForceToCenter({ m_bodyWriteForcesX[i], m_bodyWriteForcesY[i] }, true);
+			b2BodyPtr->ApplyTorque(m_bodyWriteTorques[i], true);
+			m_bodyStates.Store(entityID, b2BodyPtr);
 		}
+		m_bodyWriteEntityIDs.clear();
+		m_bodyWriteForcesX.clear();
+		m_bodyWriteForcesY.clear();
+		m_bodyWriteTorques.clear();
+		m_bodyWriteImpulsesX.clear();
+		m_bodyWriteImpulsesY.clear();
+		m_bodyWriteAngularImpulses.clear();
 	}
 	//+----------------------\------------------------------------
 	//|		   Joints		 |
@@ -20,7 +20,11 @@ struct B2_API b2BodyUserData
 
 struct B2_API b2FixtureUserData
 {
-    bool isRadar{ false };
+    b2FixtureUserData()
+    {
+        pointer = 0;
+    }
+    uintptr_t pointer;
 };
 
 struct B2_API b2JointUserData
@@ -34,18 +38,30 @@ struct B2_API b2JointUserData
 };
 
 // Memory Allocation
+// Box2D memory comes from Space's level pools (B2Allocator.cpp).
+// Define SPACE_B2_DEFAULT_ALLOC to go straight to malloc instead.
 
 B2_API void* b2Alloc_Default(int32 size);
 B2_API void b2Free_Default(void* mem);
+void* b2Alloc_Space(int32 size);
+void b2Free_Space(void* mem);
 
 inline void* b2Alloc(int32 size)
 {
+#ifdef SPACE_B2_DEFAULT_ALLOC
     return b2Alloc_Default(size);
+#else
+    return b2Alloc_Space(size);
+#endif
 }
 
 inline void b2Free(void* mem)
 {
+#ifdef SPACE_B2_DEFAULT_ALLOC
     b2Free_Default(mem);
+#else
+    b2Free_Space(mem);
+#endif
 }
 
 B2_API void b2Log_Default(const char* string, va_list args);
@@ -16,4 +16,12 @@
 #define B2_USER_SETTINGS
 #include "d2d.h"
 #include <set>
-#include <bitset>
\ No newline at end of file
+#include <bitset>
+#include <chrono>
+#include <span>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <bit>
\ No newline at end of file
@@ -0,0 +1,134 @@
+/**************************************************************************************\
+** File: SpatialGridTest.cpp
+** Project: Space
+** Author: David Leksen
+** Date:
+**
+** Checks SpatialGrid::QueryRadius against a brute-force search, including
+** circles that reach most of the way around the world, and checks that
+** QueryRadii gives the same answers with and without a worker pool. Exits
+** with failure on the first mismatch.
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "SpatialGrid.h"
+#include <random>
+#include <iostream>
+
+namespace
+{
+	using namespace Space;
+	const b2Vec2 WORLD_DIMENSIONS{ 100.0f, 100.0f };
+	const float CELL_SIZE{ 10.0f };
+	const unsigned NUM_ENTITIES{ 500 };
+	const float MAX_BOUNDING_RADIUS{ 2.0f };
+
+	struct TestEntity
+	{
+		EntityID entityID;
+		b2Vec2 position;
+		float boundingRadius;
+	};
+
+	// Same measure as SpatialGrid: the short way around the world
+	float GetGap(const b2Vec2& position, float radius, const TestEntity& entity)
+	{
+		b2Vec2 relativePosition{ entity.position - position };
+		relativePosition.x -= WORLD_DIMENSIONS.x * std::round(relativePosition.x / WORLD_DIMENSIONS.x);
+		relativePosition.y -= WORLD_DIMENSIONS.y * std::round(relativePosition.y / WORLD_DIMENSIONS.y);
+		return relativePosition.Length() - radius - entity.boundingRadius;
+	}
+	bool CheckQuery(const SpatialGrid& grid, const std::vector<TestEntity>& entities,
+		const b2Vec2& position, float radius)
+	{
+		std::vector<EntityID> expected;
+		for(const TestEntity& entity : entities)
+			if(GetGap(position, radius, entity) <= 0.0f)
+				expected.push_back(entity.entityID);
+		std::vector<EntityID> found;
+		grid.QueryRadius(position, radius, found);
+		std::sort(expected.begin(), expected.end());
+		std::sort(found.begin(), found.end());
+		if(found == expected)
+			return true;
+
+		std::cerr << "QueryRadius at (" << position.x << ", " << position.y << ") radius " << radius
+			<< " found " << found.size() << " entities, expected " << expected.size() << std::endl;
+		return false;
+	}
+	bool CheckBatch(const SpatialGrid& grid, const std::vector<AreaQuery>& queries, WorkerPool* workerPoolPtr)
+	{
+		AreaQueryResults results;
+		grid.QueryRadii(queries, results, workerPoolPtr);
+		if(results.GetNumQueries() != queries.size())
+		{
+			std::cerr << "QueryRadii answered " << results.GetNumQueries() << " of " << queries.size() << " queries" << std::endl;
+			return false;
+		}
+		std::vector<EntityID> expected;
+		for(size_t i = 0; i < queries.size(); ++i)
+		{
+			expected.clear();
+			grid.QueryRadius(queries[i].position, queries[i].radius, expected);
+			if(!std::equal(expected.begin(), expected.end(), results[i].begin(), results[i].end()))
+			{
+				std::cerr << "QueryRadii query " << i << " of " << queries.size() << " differs from QueryRadius" << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main()
+{
+	d2d::Rect worldRect;
+	worldRect.lowerBound = -0.5f * WORLD_DIMENSIONS;
+	worldRect.upperBound = 0.5f * WORLD_DIMENSIONS;
+	SpatialGrid grid;
+	grid.Init(worldRect, CELL_SIZE);
+
+	std::mt19937 generator{ 12345 };
+	std::uniform_real_distribution<float> xDistribution{ worldRect.lowerBound.x, worldRect.upperBound.x };
+	std::uniform_real_distribution<float> yDistribution{ worldRect.lowerBound.y, worldRect.upperBound.y };
+	std::uniform_real_distribution<float> boundingRadiusDistribution{ 0.5f, MAX_BOUNDING_RADIUS };
+	std::vector<TestEntity> entities;
+	for(unsigned i = 0; i < NUM_ENTITIES; ++i)
+	{
+		TestEntity entity{ MakeEntityID(i, 1), { xDistribution(generator), yDistribution(generator) },
+			boundingRadiusDistribution(generator) };
+		entities.push_back(entity);
+		grid.Update(entity.entityID, entity.position, entity.boundingRadius);
+	}
+
+	bool passed{ true };
+
+	// Small circles anywhere, including right at the edges
+	std::uniform_real_distribution<float> smallRadiusDistribution{ 0.0f, 3.0f * CELL_SIZE };
+	for(unsigned i = 0; i < 1000 && passed; ++i)
+		passed = CheckQuery(grid, entities, { xDistribution(generator), yDistribution(generator) },
+			smallRadiusDistribution(generator));
+
+	// Reach (radius plus the largest bounding radius) from well under to past half the
+	// world width. Between width - cell and width the span wraps onto its first column.
+	float halfWidth{ 0.5f * WORLD_DIMENSIONS.x };
+	for(float reach = halfWidth - CELL_SIZE; reach <= halfWidth + 0.5f * CELL_SIZE && passed; reach += 0.25f)
+		for(unsigned i = 0; i < 20 && passed; ++i)
+			passed = CheckQuery(grid, entities, { xDistribution(generator), yDistribution(generator) },
+				reach - MAX_BOUNDING_RADIUS);
+	passed = passed && CheckQuery(grid, entities, b2Vec2_zero, halfWidth - MAX_BOUNDING_RADIUS - 0.01f);
+
+	// Batches big enough to be split, and one too small to be
+	std::vector<AreaQuery> queries;
+	for(unsigned i = 0; i < 1000; ++i)
+		queries.push_back({ { xDistribution(generator), yDistribution(generator) }, smallRadiusDistribution(generator) });
+	WorkerPool workerPool;
+	workerPool.Start(3);
+	passed = passed && CheckBatch(grid, queries, nullptr) && CheckBatch(grid, queries, &workerPool);
+	queries.resize(10);
+	passed = passed && CheckBatch(grid, queries, &workerPool);
+	workerPool.Stop();
+
+	std::cout << (passed ? "SpatialGridTest passed" : "SpatialGridTest failed") << std::endl;
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,147 @@
+/**************************************************************************************\
+** File: TimerWheelTest.cpp
+** Project: Space
+** Author: David Leksen
+** Date:
+**
+** Checks that TimerWheel fires every timer on exactly its due tick: across
+** the level boundaries at 64 and 4096 ticks, past the span of the top level,
+** while paused, and when callbacks cancel or pause other timers. Exits
+** with failure on the first mismatch.
+**
+\**************************************************************************************/
+#include "pch.h"
+#include "TimerWheel.h"
+#include <iostream>
+
+namespace
+{
+	using namespace Space;
+	using TestWheel = TimerWheel<uint64_t>;
+	const uint64_t TOP_LEVEL_SPAN{ uint64_t{ 1 } << 24 };
+
+	// Schedules one timer per delay, payload being its due tick, and advances
+	// until all have fired. Fails if one fires on any other tick.
+	bool CheckDelays(TestWheel& wheel, const std::vector<uint64_t>& delays)
+	{
+		for(uint64_t delay : delays)
+			wheel.Schedule(delay, wheel.GetTick() + delay);
+
+		bool passed{ true };
+		while(wheel.GetNumPending() > 0 && passed)
+			wheel.Advance([&](TimerID, uint64_t dueTick)
+				{
+					if(dueTick != wheel.GetTick())
+					{
+						std::cerr << "Timer due at tick " << dueTick << " fired at tick " << wheel.GetTick() << std::endl;
+						passed = false;
+					}
+				});
+		return passed;
+	}
+	bool CheckCascades()
+	{
+		// Start from several ticks, so the boundaries fall at different bucket offsets
+		for(uint64_t startTick : { 0, 1, 63, 64, 4000, 4095, 4096, 4097 })
+		{
+			TestWheel wheel;
+			while(wheel.GetTick() < startTick)
+				wheel.Advance([](TimerID, uint64_t) {});
+
+			std::vector<uint64_t> delays;
+			for(uint64_t boundary : { 64, 4096, 64 * 4096 })
+				for(uint64_t delay = boundary - 2; delay <= boundary + 2; ++delay)
+					delays.push_back(delay);
+			for(uint64_t delay = 1; delay < 200; ++delay)
+				delays.push_back(delay);
+			if(!CheckDelays(wheel, delays))
+			{
+				std::cerr << "Cascade check failed starting at tick " << startTick << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+	bool CheckOverflow()
+	{
+		// Past the top level's span, timers wait in its last bucket and are placed again
+		TestWheel wheel;
+		wheel.Advance([](TimerID, uint64_t) {});
+		return CheckDelays(wheel, { TOP_LEVEL_SPAN - 1, TOP_LEVEL_SPAN, TOP_LEVEL_SPAN + 1, 2 * TOP_LEVEL_SPAN + 5 });
+	}
+	bool CheckCancelFromCallback()
+	{
+		TestWheel wheel;
+		TimerID first{ wheel.Schedule(10, 1) };
+		TimerID sameTick{ wheel.Schedule(10, 2) };
+		TimerID later{ wheel.Schedule(100, 3) };
+		TimerID rescheduled{ INVALID_TIMER_ID };
+		std::vector<uint64_t> fired;
+		for(unsigned i = 0; i < 200; ++i)
+			wheel.Advance([&](TimerID timerID, uint64_t payload)
+				{
+					fired.push_back(payload);
+					if(timerID == first || timerID == sameTick)
+					{
+						// Whichever fires first cancels the other, the later timer, and itself
+						wheel.Cancel(timerID == first ? sameTick : first);
+						wheel.Cancel(later);
+						if(wheel.Cancel(timerID))
+							fired.push_back(99);
+						rescheduled = wheel.Schedule(5, 4);
+					}
+				});
+		bool passed{ fired.size() == 2 && (fired[0] == 1 || fired[0] == 2) && fired[1] == 4 &&
+			!wheel.IsPending(first) && !wheel.IsPending(sameTick) && !wheel.IsPending(later) &&
+			!wheel.IsPending(rescheduled) && wheel.GetNumPending() == 0 };
+		if(!passed)
+			std::cerr << "Cancelling from a callback fired " << fired.size() << " timers" << std::endl;
+		return passed;
+	}
+	bool CheckPause()
+	{
+		// 10 ticks due, paused after 1 for 90 ticks: fires 9 ticks after resuming
+		TestWheel wheel;
+		TimerID timerID{ wheel.Schedule(10, 0) };
+		uint64_t firedTick{ 0 };
+		auto onExpired = [&](TimerID, uint64_t) { firedTick = wheel.GetTick(); };
+		wheel.Advance(onExpired);
+		wheel.Pause(timerID);
+		for(unsigned i = 0; i < 90; ++i)
+			wheel.Advance(onExpired);
+		bool passed{ firedTick == 0 && wheel.IsPaused(timerID) && wheel.Resume(timerID) };
+		while(wheel.GetNumPending() > 0)
+			wheel.Advance(onExpired);
+		passed = passed && firedTick == 100;
+		if(!passed)
+		{
+			std::cerr << "Paused timer fired at tick " << firedTick << ", expected 100" << std::endl;
+			return false;
+		}
+
+		// A timer paused by a callback on its due tick waits until resumed
+		TimerID a{ wheel.Schedule(5, 1) };
+		TimerID b{ wheel.Schedule(5, 2) };
+		unsigned numFired{ 0 };
+		for(unsigned i = 0; i < 10; ++i)
+			wheel.Advance([&](TimerID timerID, uint64_t)
+				{
+					++numFired;
+					wheel.Pause(timerID == a ? b : a);
+				});
+		passed = numFired == 1 && wheel.GetNumPending() == 1 && (wheel.Resume(a) || wheel.Resume(b));
+		while(wheel.GetNumPending() > 0)
+			wheel.Advance([&](TimerID, uint64_t) { ++numFired; });
+		passed = passed && numFired == 2;
+		if(!passed)
+			std::cerr << "Pausing from a callback fired " << numFired << " timers, expected 1 then 2" << std::endl;
+		return passed;
+	}
+}
+
+int main()
+{
+	bool passed{ CheckCascades() && CheckOverflow() && CheckCancelFromCallback() && CheckPause() };
+	std::cout << (passed ? "TimerWheelTest passed" : "TimerWheelTest failed") << std::endl;
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}